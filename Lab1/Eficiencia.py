@@ -1,14 +1,22 @@
+import sys
 import pandas as pd
 import matplotlib.pyplot as plt
 
-# Crear datos de ejemplo
-data = {
-    'X': [2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17],
-    'Y': [0, 0, 0, 0, 0, 0, 1, 3, 15, 89, 409, 2619, 13513, 87300, 592624, 33674360]
-}
+# Uso: python Eficiencia.py [resultados.csv]
+# El CSV es la salida de `graceful --lote ... --formato csv`; sin argumento se
+# grafican las mediciones originales tomadas a mano.
+if len(sys.argv) > 1:
+    resultados = pd.read_csv(sys.argv[1])
+    df = pd.DataFrame({'X': resultados['n'], 'Y': resultados['wall_ms']})
+else:
+    # Crear datos de ejemplo
+    data = {
+        'X': [2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17],
+        'Y': [0, 0, 0, 0, 0, 0, 1, 3, 15, 89, 409, 2619, 13513, 87300, 592624, 33674360]
+    }
 
-# Crear un DataFrame
-df = pd.DataFrame(data)
+    # Crear un DataFrame
+    df = pd.DataFrame(data)
 
 # Mostrar la tabla
 print("Tabla de datos:")
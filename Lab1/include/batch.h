@@ -0,0 +1,133 @@
+/**
+ * @file batch.h
+ * @brief Modo por lotes: barre un rango de n y emite resultados en CSV o JSON.
+ *
+ * Pensado para barridos automáticos y para seguir el rendimiento de la búsqueda
+ * entre versiones: cada fila tiene el conteo, el tiempo de pared, los nodos
+ * visitados y los nodos por segundo, lista para graficar (ver Eficiencia.py).
+ * Para medir una poda se corren dos barridos (con y sin ella) y se comparan
+ * las columnas nodes y cuts.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BATCH_MAX_REPS 1000  ///< Repeticiones máximas por n (las mediciones se guardan en la pila)
+
+/**
+ * @enum batch_format_t
+ * @brief Formatos de salida.
+ */
+typedef enum {
+    BATCH_CSV,      ///< Una fila por n, separada por comas
+    BATCH_JSON      ///< Arreglo de objetos
+} batch_format_t;
+
+/**
+ * @struct batch_sample_t
+ * @brief Resultado de una ejecución para un n.
+ */
+typedef struct {
+    uint64_t count;     /**< Permutaciones gráciles encontradas. */
+    uint64_t nodes;     /**< Nodos visitados. */
+    uint64_t cuts;      /**< Subárboles cortados por la poda por anticipación. */
+    uint64_t memo_probes;   /**< Consultas a la tabla de transposición. */
+    uint64_t memo_hits;     /**< Aciertos de la tabla de transposición. */
+} batch_sample_t;
+
+/**
+ * @brief Ejecuta la búsqueda para un n (la provee quien llama).
+ * @param n Tamaño de la permutación.
+ * @param out Resultado.
+ * @param user Puntero de usuario.
+ * @return true si la ejecución terminó correctamente.
+ */
+typedef bool (*batch_run_fn)(int n, batch_sample_t *out, void *user);
+
+/**
+ * @struct batch_config_t
+ * @brief Parámetros del barrido.
+ */
+typedef struct {
+    int from;               /**< Primer n. */
+    int to;                 /**< Último n (incluido). */
+    int reps;               /**< Repeticiones por n. */
+    batch_format_t format;  /**< Formato de salida. */
+    const char *label;      /**< Nombre de la configuración (columna engine). */
+    bool check_nodes;       /**< Exigir los mismos nodos en todas las repeticiones. */
+} batch_config_t;
+
+/**
+ * @struct batch_row_t
+ * @brief Mediciones de un n (una fila de la salida).
+ */
+typedef struct {
+    int n;                  /**< Tamaño de la permutación. */
+    int reps;               /**< Repeticiones realizadas. */
+    batch_sample_t sample;  /**< Conteo, nodos y contadores (iguales en todas las repeticiones). */
+    double wall_ms;         /**< Mediana del tiempo de pared. */
+    double wall_min_ms;     /**< Mínimo del tiempo de pared. */
+    double nodes_per_s;     /**< Nodos por segundo con la mediana. */
+    double cycles_per_node; /**< Ciclos por nodo con la mediana. */
+    double memo_hit_rate;   /**< Aciertos / consultas de la tabla de transposición. */
+} batch_row_t;
+
+/**
+ * @brief Ejecuta cfg->reps veces la búsqueda para un n y resume las mediciones.
+ *
+ * @param cfg Parámetros (se usan reps y check_nodes).
+ * @param n Tamaño de la permutación.
+ * @param run Función que ejecuta la búsqueda.
+ * @param user Puntero de usuario para @p run.
+ * @param row Mediciones.
+ * @return true si todas las ejecuciones terminaron y fueron consistentes.
+ */
+bool batch_measure(const batch_config_t *cfg, int n, batch_run_fn run, void *user, batch_row_t *row);
+
+/**
+ * @brief Escribe el encabezado CSV o la apertura del arreglo JSON.
+ */
+void batch_write_header(const batch_config_t *cfg, FILE *out);
+
+/**
+ * @brief Escribe una fila.
+ * @param cfg Parámetros (formato y etiqueta).
+ * @param row Mediciones.
+ * @param first true si es la primera fila (JSON no lleva coma antes).
+ * @param out Flujo de salida.
+ */
+void batch_write_row(const batch_config_t *cfg, const batch_row_t *row, bool first, FILE *out);
+
+/**
+ * @brief Cierra el arreglo JSON (no hace nada en CSV).
+ */
+void batch_write_footer(const batch_config_t *cfg, FILE *out);
+
+/**
+ * @brief Recorre el rango de n, mide cada ejecución y escribe los resultados.
+ *
+ * El tiempo reportado es la mediana de las repeticiones (y también el mínimo).
+ * Si el conteo (o los nodos, con check_nodes) cambia entre repeticiones se
+ * aborta, porque la búsqueda debe ser determinista.
+ *
+ * @param cfg Parámetros del barrido.
+ * @param run Función que ejecuta la búsqueda.
+ * @param user Puntero de usuario para @p run.
+ * @param out Flujo de salida.
+ * @return true si todas las ejecuciones terminaron y fueron consistentes.
+ */
+bool batch_run(const batch_config_t *cfg, batch_run_fn run, void *user, FILE *out);
+
+/**
+ * @brief Convierte el nombre de un formato ("csv" o "json").
+ * @param name Nombre del formato.
+ * @param format Formato convertido.
+ * @return true si el nombre es válido.
+ */
+bool batch_parse_format(const char *name, batch_format_t *format);
+
+#endif // BATCH_H
@@ -0,0 +1,55 @@
+/**
+ * @file checkpoint.h
+ * @brief Puntos de control en disco para búsquedas largas.
+ *
+ * El archivo guarda la frontera DFS (el camino hasta el siguiente nodo a
+ * visitar, con sus máscaras de números y diferencias) y los contadores
+ * parciales. Ocupa menos de 150 bytes y se escribe de forma atómica
+ * (archivo temporal + rename), así que una interrupción durante la escritura
+ * nunca deja un punto de control corrupto.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/graceful.h"
+
+/**
+ * @struct checkpoint_t
+ * @brief Contenido de un punto de control.
+ */
+typedef struct {
+    int n;                      /**< Tamaño de la permutación. */
+    bool symmetry;              /**< La búsqueda usa el modo de simetría. */
+    bool lookahead;             /**< La búsqueda usa la poda por anticipación. */
+    int lookahead_min_diff;     /**< Menor diferencia verificada por la poda (0: automática). */
+    bool done;                  /**< La búsqueda terminó; count es el resultado final. */
+    graceful_prefix_t at;       /**< Siguiente nodo a visitar (si !done). */
+    uint64_t count;             /**< Permutaciones contadas hasta ahora. */
+    uint64_t nodes;             /**< Nodos visitados hasta ahora. */
+} checkpoint_t;
+
+/**
+ * @brief Escribe un punto de control de forma atómica.
+ *
+ * @param path Ruta del archivo.
+ * @param cp Punto de control a guardar.
+ * @return true si se escribió y renombró correctamente.
+ */
+bool checkpoint_save(const char *path, const checkpoint_t *cp);
+
+/**
+ * @brief Lee y valida un punto de control.
+ *
+ * Verifica la firma, la versión, el CRC y que las máscaras guardadas coincidan
+ * con las que se reconstruyen a partir del prefijo.
+ *
+ * @param path Ruta del archivo.
+ * @param cp Punto de control leído.
+ * @return true si el archivo existe y es válido.
+ */
+bool checkpoint_load(const char *path, checkpoint_t *cp);
+
+#endif // CHECKPOINT_H
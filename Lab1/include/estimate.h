@@ -0,0 +1,52 @@
+/**
+ * @file estimate.h
+ * @brief Estimación del tamaño y la duración de una búsqueda antes de lanzarla.
+ *
+ * Usa sondeos aleatorios de Knuth (graceful_probe()) sobre el mismo árbol
+ * que recorre el motor con las opciones elegidas. El promedio de los sondeos
+ * estima los nodos y el conteo; el tiempo sale de dividir los nodos estimados
+ * por la velocidad del motor medida en una búsqueda exacta más chica.
+ *
+ * Los intervalos son del 95% con aproximación normal. La distribución de los
+ * sondeos tiene cola pesada (unos pocos caminos largos aportan casi todo),
+ * así que con pocos sondeos el intervalo tiende a quedarse corto.
+ */
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/graceful.h"
+
+/**
+ * @struct estimate_t
+ * @brief Resultado de una estimación.
+ */
+typedef struct {
+    int probes;         /**< Sondeos realizados. */
+    double nodes;       /**< Nodos estimados. */
+    double nodes_ci;    /**< Semiancho del intervalo de los nodos. */
+    double count;       /**< Permutaciones gráciles estimadas. */
+    double count_ci;    /**< Semiancho del intervalo del conteo. */
+    int count_hits;     /**< Sondeos que llegaron a alguna hoja (con 0 el conteo no está estimado). */
+    double rate;        /**< Nodos por segundo medidos. */
+    int rate_n;         /**< n de la búsqueda exacta usada para medir la velocidad. */
+    double seconds;     /**< Tiempo estimado de la búsqueda serial. */
+    double seconds_ci;  /**< Semiancho del intervalo del tiempo. */
+} estimate_t;
+
+/**
+ * @brief Estima nodos, conteo y tiempo de la búsqueda completa para n.
+ *
+ * @param n Tamaño de la permutación.
+ * @param opt Opciones del motor (las mismas que tendrá la búsqueda real).
+ * @param probes Cantidad de sondeos.
+ * @param tail Niveles finales de cada sondeo que se recorren exactos.
+ * @param seed Semilla del generador (0 se reemplaza por una fija).
+ * @param out Estimación.
+ */
+void graceful_estimate(int n, const graceful_options_t *opt, int probes, int tail, uint64_t seed,
+                       estimate_t *out);
+
+#endif // ESTIMATE_H
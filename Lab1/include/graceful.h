@@ -0,0 +1,282 @@
+/**
+ * @file graceful.h
+ * @brief Motor de búsqueda de permutaciones gráciles basado en máscaras de bits.
+ *
+ * Los números usados y las diferencias usadas se representan como conjuntos de
+ * bits en una palabra de máquina. En cada nivel solo se visitan los candidatos
+ * prev-d y prev+d para cada diferencia d libre, en lugar de recorrer 1..n.
+ *
+ * Modo de simetría: toda permutación grácil p tiene como hermanas su reversa R(p),
+ * su complemento C(p) (i -> n+1-i) y RC(p). Los números 1 y n siempre son
+ * vecinos (es la única pareja con diferencia n-1), así que la arista {1, n}
+ * identifica la clase: R la refleja de posición y cambia su orientación, C solo
+ * cambia la orientación. El modo canónico exige que 1 vaya inmediatamente antes
+ * de n y que la posición i del 1 cumpla 2i <= n-2. Cada representante pesa 4,
+ * salvo cuando 2i == n-2: ahí p y RC(p) son ambos canónicos (o iguales, si p es
+ * autosimétrica) y cada uno pesa 2.
+ *
+ * Poda por anticipación: una diferencia grande d solo la realizan las parejas
+ * (x, x+d) con x <= n-d, que son pocas. Tras cada colocación se verifica que
+ * cada diferencia libre d >= lookahead_min_diff tenga al menos una pareja con
+ * ambos extremos disponibles (sin usar, o el último elemento colocado); si
+ * alguna ya no la tiene, el subárbol no tiene soluciones y se corta.
+ */
+
+#ifndef GRACEFUL_H
+#define GRACEFUL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <stdio.h>
+#include "include/memo.h"
+
+#define GRACEFUL_MAX_N 50  ///< Valor máximo de n soportado por las máscaras de 64 bits
+#define GRACEFUL_MEMO_MIN_LEFT 3 ///< Elementos faltantes mínimos para consultar la tabla de transposición
+
+/// Conjunto de bits: el bit i representa el número (o la diferencia) i.
+typedef uint64_t graceful_mask_t;
+
+/// Máscara con únicamente el bit @p i encendido.
+#define GRACEFUL_BIT(i) ((graceful_mask_t)1 << (i))
+
+#ifdef GRACEFUL_STATS
+/**
+ * @struct graceful_stats_t
+ * @brief Contadores por profundidad de la ruta caliente.
+ *
+ * Solo existen al compilar con -DGRACEFUL_STATS; sin esa bandera las macros
+ * GRACEFUL_STAT_* no generan código y la búsqueda no paga nada.
+ */
+typedef struct {
+    uint64_t expanded[GRACEFUL_MAX_N + 1];  /**< Nodos visitados por profundidad. */
+    uint64_t rejected[GRACEFUL_MAX_N + 1];  /**< Candidatos prev±d descartados (fuera de rango o usados). */
+    uint64_t cut[GRACEFUL_MAX_N + 1];       /**< Subárboles cortados por poda. */
+    uint64_t leaves;                        /**< Permutaciones completas alcanzadas (sin ponderar). */
+} graceful_stats_t;
+
+#define GRACEFUL_STAT_ADD(s, field, depth) ((s)->stats.field[depth]++)
+#define GRACEFUL_STAT_LEAF(s) ((s)->stats.leaves++)
+#else
+#define GRACEFUL_STAT_ADD(s, field, depth) ((void)0)
+#define GRACEFUL_STAT_LEAF(s) ((void)0)
+#endif
+
+/**
+ * @struct graceful_options_t
+ * @brief Opciones del motor de búsqueda.
+ */
+typedef struct {
+    bool symmetry;      /**< Explorar solo un representante por clase de simetría. */
+    bool lookahead;     /**< Activar la poda por anticipación. */
+    int lookahead_min_diff; /**< Menor diferencia verificada (0: (n+1)/2). */
+} graceful_options_t;
+
+/**
+ * @struct graceful_prefix_t
+ * @brief Prefijo válido de una permutación, usado como unidad de trabajo.
+ */
+typedef struct {
+    int depth;                      /**< Cantidad de elementos colocados. */
+    graceful_mask_t used;           /**< Números usados por el prefijo. */
+    graceful_mask_t free_diffs;     /**< Diferencias aún no usadas. */
+    uint8_t weight;                 /**< Peso de la arista {1, n} si ya está en el prefijo. */
+    uint8_t perm[GRACEFUL_MAX_N];   /**< Elementos del prefijo. */
+} graceful_prefix_t;
+
+/**
+ * @brief Función llamada por cada prefijo generado.
+ * @param prefix Prefijo generado (válido solo durante la llamada).
+ * @param user Puntero de usuario.
+ */
+typedef void (*graceful_prefix_cb)(const graceful_prefix_t *prefix, void *user);
+
+/**
+ * @brief Función llamada al tomar un punto de control.
+ * @param at Nodo en el que se detuvo la búsqueda (aún no visitado).
+ * @param count Permutaciones contadas antes de ese nodo.
+ * @param nodes Nodos visitados antes de ese nodo.
+ * @param user Puntero de usuario.
+ */
+typedef void (*graceful_checkpoint_cb)(const graceful_prefix_t *at, uint64_t count,
+                                       uint64_t nodes, void *user);
+
+/**
+ * @brief Función llamada por cada permutación grácil encontrada.
+ * @param perm Permutación (valores 1..n, válida solo durante la llamada).
+ * @param n Tamaño de la permutación.
+ * @param user Puntero de usuario.
+ */
+typedef void (*graceful_leaf_cb)(const int *perm, int n, void *user);
+
+/**
+ * @struct graceful_search_t
+ * @brief Estado de una búsqueda. Cada hilo o proceso usa su propia instancia.
+ */
+typedef struct {
+    int n;                          /**< Tamaño de la permutación. */
+    graceful_options_t opt;         /**< Opciones activas. */
+    graceful_mask_t numbers;        /**< Máscara con los números 1..n. */
+    graceful_mask_t diffs;          /**< Máscara con las diferencias 1..n-1. */
+    graceful_mask_t edge_bit;       /**< Bit de la diferencia n-1 (arista {1, n}). */
+    int edge_limit;                 /**< Última posición válida de n en modo simetría. */
+    uint64_t weight;                /**< Peso de las hojas bajo la arista {1, n} actual. */
+    uint8_t edge_weight[GRACEFUL_MAX_N + 1]; /**< Peso según la posición de n. */
+    graceful_mask_t lookahead_mask; /**< Diferencias verificadas por la poda por anticipación. */
+    memo_table_t *memo;             /**< Tabla de transposición (NULL: desactivada). */
+    int memo_from;                  /**< Primera profundidad que consulta la tabla. */
+    int memo_to;                    /**< Última profundidad que consulta la tabla. */
+    uint64_t lookahead_cuts;        /**< Subárboles cortados por la poda por anticipación. */
+    uint64_t count;                 /**< Permutaciones gráciles encontradas (ya ponderadas). */
+    uint64_t nodes;                 /**< Nodos visitados del árbol de búsqueda. */
+    int perm[GRACEFUL_MAX_N];       /**< Prefijo actual de la permutación. */
+    volatile sig_atomic_t *checkpoint_flag; /**< Bandera externa que pide un punto de control (NULL: desactivado). */
+    graceful_checkpoint_cb checkpoint_cb;   /**< Función que guarda el punto de control. */
+    void *checkpoint_user;                  /**< Puntero de usuario para @ref checkpoint_cb. */
+    graceful_leaf_cb leaf_cb;       /**< Función que recibe cada permutación (NULL: solo contar). */
+    void *leaf_user;                /**< Puntero de usuario para @ref leaf_cb. */
+#ifdef GRACEFUL_STATS
+    graceful_stats_t stats;         /**< Instrumentación por profundidad. */
+#endif
+} graceful_search_t;
+
+/**
+ * @brief Inicializa el estado de búsqueda para un tamaño n.
+ *
+ * @param s Estado a inicializar.
+ * @param n Tamaño de la permutación (1..GRACEFUL_MAX_N).
+ * @param opt Opciones del motor (NULL: valores por defecto).
+ */
+void graceful_search_init(graceful_search_t *s, int n, const graceful_options_t *opt);
+
+/**
+ * @brief Explora el subárbol que cuelga de un prefijo.
+ *
+ * Acumula en s->count y s->nodes, contando el propio nodo del prefijo.
+ *
+ * @param s Estado de búsqueda.
+ * @param prefix Prefijo de partida (depth >= 1).
+ */
+void graceful_search_prefix(graceful_search_t *s, const graceful_prefix_t *prefix);
+
+/**
+ * @brief Genera, en el mismo orden que la búsqueda, todos los prefijos válidos de una longitud.
+ *
+ * Los nodos por encima de la profundidad de corte (incluida la raíz) se suman a
+ * s->nodes, de modo que al explorar después cada prefijo con
+ * graceful_search_prefix() el total de nodos coincide con graceful_count().
+ *
+ * @param s Estado de búsqueda (s->perm se usa como espacio de trabajo).
+ * @param depth Longitud de los prefijos (1..n).
+ * @param cb Función llamada por cada prefijo.
+ * @param user Puntero de usuario para @p cb.
+ */
+void graceful_enumerate_prefixes(graceful_search_t *s, int depth,
+                                 graceful_prefix_cb cb, void *user);
+
+/**
+ * @brief Cuenta todas las permutaciones gráciles de tamaño s->n.
+ *
+ * @param s Estado inicializado con graceful_search_init().
+ * @return Número de permutaciones gráciles (también queda en s->count).
+ */
+uint64_t graceful_count(graceful_search_t *s);
+
+/**
+ * @brief Un sondeo aleatorio de Knuth sobre el árbol de search().
+ *
+ * Baja desde la raíz eligiendo en cada nodo un hijo al azar (con las mismas
+ * reglas de hijos y podas que la búsqueda) hasta una hoja o un nodo sin hijos.
+ * Si d_0, d_1, ... son los grados encontrados, 1 + d_0 + d_0*d_1 + ... es un
+ * estimador insesgado de s->nodes, y el producto de los grados por el conteo
+ * del subárbol alcanzado lo es del conteo. Los últimos @p tail niveles se
+ * recorren exactos con search(): las hojas gráciles son raras y un sondeo
+ * puro casi nunca llega a una, mientras que la cola exacta reduce mucho la
+ * varianza de ambos estimadores.
+ *
+ * @param s Estado inicializado (sus contadores no cambian; usa s->perm).
+ * @param tail Niveles finales que se exploran exactos (0: sondeo puro).
+ * @param rng Estado del generador xorshift64 (distinto de cero).
+ * @param nodes Estimación de los nodos de la búsqueda completa.
+ * @param count Estimación del conteo.
+ */
+void graceful_probe(graceful_search_t *s, int tail, uint64_t *rng, double *nodes, double *count);
+
+#ifdef GRACEFUL_STATS
+/**
+ * @brief Suma los contadores de @p src en @p dst (para combinar hilos).
+ * @param dst Acumulador.
+ * @param src Contadores a sumar.
+ */
+void graceful_stats_merge(graceful_stats_t *dst, const graceful_stats_t *src);
+
+/**
+ * @brief Imprime una tabla por profundidad con los contadores.
+ * @param stats Contadores.
+ * @param n Tamaño de la permutación.
+ * @param out Flujo de salida.
+ */
+void graceful_stats_print(const graceful_stats_t *stats, int n, FILE *out);
+#endif
+
+/**
+ * @brief Activa los puntos de control.
+ *
+ * Cuando @p flag vale distinto de cero, el siguiente nodo visitado la pone en
+ * cero y llama a @p cb con la frontera DFS (el camino hasta ese nodo) y los
+ * contadores parciales. Revisar la bandera cuesta una lectura por nodo.
+ *
+ * @param s Estado de búsqueda.
+ * @param flag Bandera, normalmente escrita desde un manejador de señal.
+ * @param cb Función que guarda el punto de control.
+ * @param user Puntero de usuario para @p cb.
+ */
+void graceful_set_checkpoint(graceful_search_t *s, volatile sig_atomic_t *flag,
+                             graceful_checkpoint_cb cb, void *user);
+
+/**
+ * @brief Activa la tabla de transposición.
+ *
+ * Se consulta en los nodos a los que les faltan entre GRACEFUL_MEMO_MIN_LEFT y
+ * @p levels elementos; más cerca de las hojas el subárbol cuesta menos que la
+ * consulta. Solo se guardan subárboles explorados completos, y los nodos del
+ * camino de una reanudación no se guardan. Con la tabla activa s->nodes cuenta
+ * los nodos realmente visitados, que dependen del tamaño de la tabla.
+ *
+ * @param s Estado de búsqueda.
+ * @param memo Tabla (propia de este estado; NULL: desactivar).
+ * @param levels Elementos faltantes máximos para consultar la tabla.
+ */
+void graceful_set_memo(graceful_search_t *s, memo_table_t *memo, int levels);
+
+/**
+ * @brief Entrega cada permutación encontrada a @p cb.
+ *
+ * En modo simetría se entrega la clase completa de cada representante (p, R,
+ * C y RC si pesa 4; p y R si pesa 2), así que @p cb recibe exactamente s->count
+ * permutaciones, todas distintas. No es compatible con la tabla de
+ * transposición, que salta subárboles sin recorrer sus hojas.
+ *
+ * @param s Estado de búsqueda.
+ * @param cb Función por permutación (NULL: desactivar).
+ * @param user Puntero de usuario para @p cb.
+ */
+void graceful_set_leaf(graceful_search_t *s, graceful_leaf_cb cb, void *user);
+
+/**
+ * @brief Continúa una búsqueda desde un punto de control.
+ *
+ * Recorre el camino guardado saltando los hermanos ya explorados y sigue
+ * normalmente desde ahí, de modo que el conteo final y los nodos visitados
+ * son idénticos a los de una ejecución sin interrupciones.
+ *
+ * @param s Estado inicializado con las mismas opciones que la ejecución original.
+ * @param at Nodo guardado por el punto de control.
+ * @param count Conteo parcial guardado.
+ * @param nodes Nodos visitados guardados.
+ * @return Número total de permutaciones gráciles.
+ */
+uint64_t graceful_resume(graceful_search_t *s, const graceful_prefix_t *at,
+                         uint64_t count, uint64_t nodes);
+
+#endif // GRACEFUL_H
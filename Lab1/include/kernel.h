@@ -0,0 +1,35 @@
+/**
+ * @file kernel.h
+ * @brief Núcleos de búsqueda especializados para cada n en tiempo de compilación.
+ *
+ * El motor genérico (graceful.c) recibe n en tiempo de ejecución y recurre
+ * con una llamada por nodo. Aquí una macro genera una función por cada n de
+ * GRACEFUL_KERNEL_MIN_N a GRACEFUL_KERNEL_MAX_N en la que n, las máscaras de
+ * números y diferencias y el tamaño de la pila son constantes, y la
+ * recursión se reemplaza por una pila explícita de tamaño fijo.
+ *
+ * Los núcleos hacen la búsqueda completa (sin simetría ni podas) y recorren
+ * exactamente el mismo árbol que graceful_count(), así que los conteos y los
+ * nodos visitados coinciden y se pueden comparar directamente en el modo por lotes.
+ */
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GRACEFUL_KERNEL_MIN_N 2     ///< Menor n con núcleo especializado
+#define GRACEFUL_KERNEL_MAX_N 24    ///< Mayor n con núcleo especializado
+
+/**
+ * @brief Cuenta las permutaciones gráciles con el núcleo especializado de n.
+ *
+ * @param n Tamaño de la permutación.
+ * @param count Permutaciones gráciles encontradas.
+ * @param nodes Nodos visitados (raíz incluida, igual que graceful_count()).
+ * @return false si no hay núcleo para ese n.
+ */
+bool graceful_kernel_count(int n, uint64_t *count, uint64_t *nodes);
+
+#endif // KERNEL_H
@@ -0,0 +1,155 @@
+/**
+ * @file memo.h
+ * @brief Tabla de transposición para la búsqueda de permutaciones gráciles.
+ *
+ * Muchos prefijos distintos llegan al mismo estado: mismos números usados,
+ * mismas diferencias libres y mismo último elemento. Ese estado determina por
+ * completo cuántas formas hay de terminar la permutación, así que basta con
+ * explorarlo una vez y recordar el resultado.
+ *
+ * La tabla tiene memoria acotada: es un arreglo de cubetas de MEMO_WAYS
+ * entradas. Cuando una cubeta se llena se reemplaza la entrada cuyo subárbol
+ * costó menos nodos, de modo que sobreviven los resultados más caros de repetir.
+ */
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MEMO_WAYS 4     ///< Entradas por cubeta
+
+/**
+ * @struct memo_entry_t
+ * @brief Resultado guardado de un estado.
+ */
+typedef struct {
+    uint64_t key;       /**< Números usados con el último elemento en los bits 56..63 (0: vacía). */
+    uint64_t diffs;     /**< Diferencias libres. */
+    uint32_t count;     /**< Completaciones del estado (sin el peso de simetría). */
+    uint32_t work;      /**< Nodos que costó el subárbol (saturado): prioridad de reemplazo. */
+} memo_entry_t;
+
+/**
+ * @struct memo_bucket_t
+ * @brief Cubeta de entradas con el mismo índice.
+ */
+typedef struct {
+    memo_entry_t slot[MEMO_WAYS];   /**< Entradas. */
+} memo_bucket_t;
+
+/**
+ * @struct memo_table_t
+ * @brief Tabla de transposición y sus estadísticas. Una por hilo.
+ */
+typedef struct {
+    memo_bucket_t *buckets;     /**< Cubetas (potencia de dos). */
+    uint64_t mask;              /**< Cantidad de cubetas - 1. */
+    uint64_t probes;            /**< Consultas. */
+    uint64_t hits;              /**< Consultas con resultado guardado. */
+    uint64_t stores;            /**< Resultados guardados. */
+    uint64_t evictions;         /**< Entradas ocupadas que se reemplazaron. */
+} memo_table_t;
+
+/**
+ * @brief Reserva una tabla que ocupe a lo sumo @p bytes.
+ *
+ * @param t Tabla a inicializar.
+ * @param bytes Presupuesto de memoria (al menos una cubeta).
+ * @return true si se pudo reservar.
+ */
+bool memo_init(memo_table_t *t, size_t bytes);
+
+/**
+ * @brief Libera la memoria de la tabla.
+ * @param t Tabla.
+ */
+void memo_free(memo_table_t *t);
+
+/**
+ * @brief Suma las estadísticas de @p src en @p dst (para combinar hilos).
+ * @param dst Acumulador.
+ * @param src Estadísticas a sumar.
+ */
+void memo_stats_merge(memo_table_t *dst, const memo_table_t *src);
+
+/**
+ * @brief Clave de un estado.
+ * @param used Números usados (bits 1..50).
+ * @param prev Último elemento colocado.
+ * @return Clave, nunca cero.
+ */
+static inline uint64_t memo_key(uint64_t used, int prev) {
+    return used | ((uint64_t)prev << 56);
+}
+
+/**
+ * @brief Cubeta que corresponde a un estado.
+ */
+static inline memo_bucket_t *memo_bucket(const memo_table_t *t, uint64_t key, uint64_t diffs) {
+    uint64_t h = key * 0x9E3779B97F4A7C15ull ^ diffs * 0xC2B2AE3D27D4EB4Full;
+    h ^= h >> 31;
+    return &t->buckets[h & t->mask];
+}
+
+/**
+ * @brief Busca un estado.
+ *
+ * @param t Tabla.
+ * @param key Clave de memo_key().
+ * @param diffs Diferencias libres.
+ * @param count Completaciones guardadas (si hay acierto).
+ * @return true si el estado estaba en la tabla.
+ */
+static inline bool memo_probe(memo_table_t *t, uint64_t key, uint64_t diffs, uint64_t *count) {
+    memo_bucket_t *b = memo_bucket(t, key, diffs);
+    t->probes++;
+    for (int i = 0; i < MEMO_WAYS; i++) {
+        if (b->slot[i].key == key && b->slot[i].diffs == diffs) {
+            *count = b->slot[i].count;
+            t->hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Guarda el resultado de un estado, reemplazando la entrada más barata si hace falta.
+ *
+ * @param t Tabla.
+ * @param key Clave de memo_key().
+ * @param diffs Diferencias libres.
+ * @param count Completaciones del estado.
+ * @param work Nodos que costó explorar el estado.
+ */
+static inline void memo_store(memo_table_t *t, uint64_t key, uint64_t diffs,
+                              uint64_t count, uint64_t work) {
+    if (count > UINT32_MAX) {
+        return;
+    }
+    memo_bucket_t *b = memo_bucket(t, key, diffs);
+    memo_entry_t *victim = &b->slot[0];
+    for (int i = 0; i < MEMO_WAYS; i++) {
+        memo_entry_t *e = &b->slot[i];
+        if (e->key == 0) {
+            victim = e;
+            break;
+        }
+        if (e->work < victim->work) {
+            victim = e;
+        }
+    }
+    if (victim->key != 0) {
+        t->evictions++;
+    }
+    victim->key = key;
+    victim->diffs = diffs;
+    victim->count = (uint32_t)count;
+    victim->work = work > UINT32_MAX ? UINT32_MAX : (uint32_t)work;
+    t->stores++;
+}
+
+#endif // MEMO_H
@@ -0,0 +1,110 @@
+/**
+ * @file output.h
+ * @brief Escritura binaria de permutaciones a alta velocidad.
+ *
+ * Formato del archivo (sin encabezado, registros de tamaño fijo):
+ * - crudo: n bytes por permutación, cada uno un valor 1..n;
+ * - rango: 8 bytes little-endian por permutación con su rango lexicográfico
+ *   (código de Lehmer, 0..n!-1), solo para n <= 20.
+ *
+ * El destino (perm_sink_t) es un descriptor compartido. Cada hilo escribe en
+ * su propio perm_writer_t, que acumula registros en un búfer grande y lo vuelca
+ * con una sola llamada a write() bajo el mutex del destino. Así la búsqueda no
+ * hace llamadas al sistema por permutación y los hilos no se bloquean entre sí
+ * salvo al volcar. Con varios hilos el orden de los registros no es determinista.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define PERM_RANK_MAX_N 20                  ///< Mayor n cuyo rango entra en 64 bits
+#define PERM_WRITER_BUFFER (4u << 20)       ///< Búfer por escritor (4 MiB)
+
+/**
+ * @struct perm_sink_t
+ * @brief Archivo de salida compartido por los escritores.
+ */
+typedef struct {
+    int fd;                 /**< Descriptor del archivo. */
+    pthread_mutex_t lock;   /**< Serializa los volcados. */
+    int n;                  /**< Tamaño de las permutaciones. */
+    bool rank;              /**< Registros de 8 bytes con el rango. */
+    bool failed;            /**< Falló alguna escritura. */
+    uint64_t records;       /**< Registros volcados. */
+} perm_sink_t;
+
+/**
+ * @struct perm_writer_t
+ * @brief Búfer privado de un hilo.
+ */
+typedef struct {
+    perm_sink_t *sink;      /**< Destino de los volcados. */
+    uint8_t *buf;           /**< Registros pendientes. */
+    size_t len;             /**< Bytes pendientes. */
+    size_t cap;             /**< Capacidad del búfer (múltiplo del registro). */
+    size_t record;          /**< Bytes por registro. */
+} perm_writer_t;
+
+/**
+ * @brief Crea (o trunca) el archivo de salida.
+ *
+ * @param sink Destino a inicializar.
+ * @param path Ruta del archivo.
+ * @param n Tamaño de las permutaciones.
+ * @param rank true para escribir rangos en lugar de los valores.
+ * @return true si se pudo abrir (y n admite rango, si se pidió).
+ */
+bool perm_sink_open(perm_sink_t *sink, const char *path, int n, bool rank);
+
+/**
+ * @brief Cierra el archivo.
+ * @param sink Destino.
+ * @return true si todas las escrituras y el cierre fueron correctos.
+ */
+bool perm_sink_close(perm_sink_t *sink);
+
+/**
+ * @brief Reserva el búfer de un escritor.
+ *
+ * @param w Escritor a inicializar.
+ * @param sink Destino compartido.
+ * @param bytes Tamaño aproximado del búfer.
+ * @return true si se pudo reservar.
+ */
+bool perm_writer_init(perm_writer_t *w, perm_sink_t *sink, size_t bytes);
+
+/**
+ * @brief Vuelca el búfer pendiente al destino.
+ * @param w Escritor.
+ */
+void perm_writer_flush(perm_writer_t *w);
+
+/**
+ * @brief Vuelca lo pendiente y libera el búfer.
+ * @param w Escritor.
+ */
+void perm_writer_free(perm_writer_t *w);
+
+/**
+ * @brief Agrega una permutación (compatible con graceful_leaf_cb; @p user es el escritor).
+ *
+ * @param perm Permutación de valores 1..n.
+ * @param n Tamaño.
+ * @param user Escritor (perm_writer_t *).
+ */
+void perm_writer_put(const int *perm, int n, void *user);
+
+/**
+ * @brief Rango lexicográfico de una permutación de 1..n.
+ * @param perm Permutación.
+ * @param n Tamaño (<= PERM_RANK_MAX_N).
+ * @return Rango en 0..n!-1.
+ */
+uint64_t perm_rank(const int *perm, int n);
+
+#endif // OUTPUT_H
@@ -0,0 +1,74 @@
+/**
+ * @file parallel.h
+ * @brief Conteo paralelo de permutaciones gráciles con robo de trabajo.
+ *
+ * El árbol de búsqueda se corta en prefijos a una profundidad configurable.
+ * Cada prefijo es una tarea; las tareas se reparten entre colas dobles (una
+ * por hilo) y los hilos que se quedan sin trabajo roban de las colas ajenas.
+ * Cada hilo tiene su propio estado de búsqueda (y su propia tabla de
+ * transposición, con una parte del presupuesto de memoria) y los contadores se
+ * suman al final. Con tabla, los nodos visitados dependen del reparto.
+ *
+ * Fragmentos: varios procesos independientes (en distintas máquinas) pueden
+ * repartirse los prefijos. El fragmento i de k explora las tareas cuyo índice
+ * en el orden de generación es congruente con i módulo k; el orden es
+ * determinista, así que los fragmentos son disjuntos y cubren todo el árbol.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "include/graceful.h"
+#include "include/output.h"
+#include "include/progress.h"
+
+/**
+ * @struct graceful_parallel_config_t
+ * @brief Parámetros del modo paralelo.
+ */
+typedef struct {
+    int threads;        /**< Hilos a usar (0: uno por núcleo disponible). */
+    int split_depth;    /**< Profundidad de corte en prefijos (0: automática). */
+    graceful_options_t search; /**< Opciones del motor usadas por cada hilo. */
+    size_t memo_bytes;  /**< Memoria total de las tablas de transposición (0: sin tabla). */
+    int memo_levels;    /**< Elementos faltantes máximos para consultar la tabla. */
+    perm_sink_t *output; /**< Destino de las permutaciones (NULL: solo contar). */
+    int shard_index;    /**< Fragmento a explorar (0..shard_count-1). */
+    int shard_count;    /**< Fragmentos en que se reparte el árbol (0 o 1: todo). */
+    progress_t *progress; /**< Contadores de progreso (NULL: sin informe). */
+} graceful_parallel_config_t;
+
+/**
+ * @struct graceful_parallel_result_t
+ * @brief Resultado agregado de una ejecución paralela.
+ */
+typedef struct {
+    uint64_t count;     /**< Permutaciones gráciles encontradas. */
+    uint64_t nodes;     /**< Nodos visitados (igual que en la búsqueda serial). */
+    uint64_t lookahead_cuts; /**< Subárboles cortados por la poda por anticipación. */
+    size_t tasks;       /**< Prefijos explorados por este proceso. */
+    size_t total_tasks; /**< Prefijos de todos los fragmentos. */
+    size_t steals;      /**< Tareas ejecutadas por un hilo distinto a su dueño. */
+    int threads;        /**< Hilos usados. */
+    int split_depth;    /**< Profundidad de corte usada. */
+    memo_table_t memo;  /**< Estadísticas sumadas de las tablas de transposición. */
+#ifdef GRACEFUL_STATS
+    graceful_stats_t stats; /**< Instrumentación sumada de todos los hilos. */
+#endif
+} graceful_parallel_result_t;
+
+/**
+ * @brief Cuenta las permutaciones gráciles de tamaño n usando varios hilos.
+ *
+ * @param n Tamaño de la permutación.
+ * @param cfg Configuración (hilos y profundidad de corte).
+ * @param out Resultado agregado.
+ * @return true si la ejecución terminó, false si no se pudo reservar memoria o crear hilos.
+ */
+bool graceful_count_parallel(int n, const graceful_parallel_config_t *cfg,
+                             graceful_parallel_result_t *out);
+
+#endif // PARALLEL_H
@@ -0,0 +1,81 @@
+/**
+ * @file progress.h
+ * @brief Progreso y tiempo restante de una búsqueda larga.
+ *
+ * Los hilos de búsqueda publican cada tarea (prefijo) terminada y sus nodos en
+ * contadores atómicos con orden relajado: una suma por tarea, nunca por nodo,
+ * y sin bloqueos ni llamadas al sistema. Un hilo aparte los lee cada cierto
+ * intervalo y escribe el porcentaje de tareas terminadas, los nodos por
+ * segundo y una estimación del tiempo restante en stderr o en un archivo de
+ * estado (reescrito completo con archivo temporal + rename).
+ *
+ * El tiempo restante supone que las tareas pendientes duran en promedio lo
+ * mismo que las terminadas; como el tamaño de los subárboles varía mucho, es
+ * una guía y no un plazo.
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * @struct progress_t
+ * @brief Contadores compartidos y estado del hilo que informa.
+ */
+typedef struct {
+    _Atomic uint64_t tasks_done;    /**< Tareas terminadas. */
+    _Atomic uint64_t tasks_total;   /**< Tareas de la búsqueda (0: aún no se generaron). */
+    _Atomic uint64_t nodes;         /**< Nodos de las tareas terminadas y de la cabecera. */
+    int n;                          /**< Tamaño de la permutación (solo para el informe). */
+    int interval_s;                 /**< Segundos entre informes. */
+    const char *status_path;        /**< Archivo de estado (NULL: stderr). */
+    uint64_t start_ns;              /**< Inicio de la búsqueda. */
+    bool running;                   /**< El hilo que informa está activo. */
+    bool stop;                      /**< Pedido de parada (protegido por @ref lock). */
+    pthread_mutex_t lock;           /**< Protege @ref stop. */
+    pthread_cond_t wake;            /**< Despierta al hilo que informa para terminar. */
+    pthread_t thread;               /**< Hilo que informa. */
+} progress_t;
+
+/**
+ * @brief Inicia el hilo que informa el progreso.
+ *
+ * @param p Estado a inicializar.
+ * @param n Tamaño de la permutación.
+ * @param interval_s Segundos entre informes (>= 1).
+ * @param status_path Archivo de estado, o NULL para escribir en stderr.
+ * @return true si el hilo arrancó.
+ */
+bool progress_start(progress_t *p, int n, int interval_s, const char *status_path);
+
+/**
+ * @brief Publica la cantidad total de tareas y los nodos recorridos al generarlas.
+ * @param p Estado de progreso.
+ * @param tasks Tareas a explorar.
+ * @param head_nodes Nodos por encima de la profundidad de corte.
+ */
+void progress_set_total(progress_t *p, uint64_t tasks, uint64_t head_nodes);
+
+/**
+ * @brief Publica una tarea terminada. Se llama una vez por tarea, fuera de la recursión.
+ * @param p Estado de progreso (NULL: no hace nada).
+ * @param nodes Nodos visitados por la tarea.
+ */
+static inline void progress_task_done(progress_t *p, uint64_t nodes) {
+    if (p) {
+        atomic_fetch_add_explicit(&p->nodes, nodes, memory_order_relaxed);
+        atomic_fetch_add_explicit(&p->tasks_done, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Detiene el hilo que informa después de escribir un último informe.
+ * @param p Estado de progreso.
+ */
+void progress_stop(progress_t *p);
+
+#endif // PROGRESS_H
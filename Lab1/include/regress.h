@@ -0,0 +1,54 @@
+/**
+ * @file regress.h
+ * @brief Compuerta de regresión: verifica los conteos conocidos y compara el rendimiento con una base.
+ *
+ * Recorre n = 1..to con la configuración elegida, exige que cada conteo sea
+ * el publicado y compara la velocidad con un archivo base, que
+ * es simplemente la salida CSV del modo por lotes. Si los nodos de un n
+ * coinciden con la base se comparan nodos por segundo; si el árbol cambió (una
+ * poda nueva, por ejemplo) se compara el tiempo de pared. Los n cuya base dura
+ * menos de min_ms no se comparan porque el ruido de medición los domina.
+ */
+
+#ifndef REGRESS_H
+#define REGRESS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "include/batch.h"
+
+#define REGRESS_KNOWN_MAX_N 16  ///< Mayor n con conteo conocido en la tabla
+
+/**
+ * @struct regress_config_t
+ * @brief Parámetros de la compuerta.
+ */
+typedef struct {
+    int to;                     /**< Último n verificado (<= REGRESS_KNOWN_MAX_N). */
+    const char *baseline_path;  /**< Archivo base (CSV del modo por lotes; NULL: sin comparar). */
+    bool update;                /**< Reescribir la base con esta medición si los conteos son correctos. */
+    double tolerance;           /**< Pérdida de velocidad admitida (0.10 = 10%). */
+    double min_ms;              /**< Duración mínima en la base para comparar la velocidad. */
+} regress_config_t;
+
+/**
+ * @brief Conteo publicado de permutaciones gráciles.
+ * @param n Tamaño (1..REGRESS_KNOWN_MAX_N).
+ * @return Conteo, o 0 si no está en la tabla.
+ */
+uint64_t regress_known_count(int n);
+
+/**
+ * @brief Ejecuta la compuerta y escribe un informe por n.
+ *
+ * @param batch Parámetros de medición (repeticiones, etiqueta de la configuración).
+ * @param cfg Parámetros de la compuerta.
+ * @param run Función que ejecuta la búsqueda.
+ * @param user Puntero de usuario para @p run.
+ * @param out Flujo del informe.
+ * @return Cantidad de fallas (conteos incorrectos o regresiones), o -1 si no se pudo ejecutar.
+ */
+int regress_run(const batch_config_t *batch, const regress_config_t *cfg, batch_run_fn run, void *user,
+                FILE *out);
+
+#endif // REGRESS_H
@@ -0,0 +1,65 @@
+/**
+ * @file shard.h
+ * @brief Archivos de resultado de los fragmentos y su combinación.
+ *
+ * Cada proceso lanzado con --shard i/k escribe un archivo de texto pequeño con
+ * una línea clave=valor por campo. La combinación verifica que todos los
+ * archivos describan la misma búsqueda (n, opciones, profundidad de corte y
+ * cantidad de fragmentos), que estén todos los fragmentos exactamente una vez
+ * y que las tareas sumen el total antes de sumar conteos y nodos.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @struct shard_result_t
+ * @brief Resultado de un fragmento.
+ */
+typedef struct {
+    int n;                  /**< Tamaño de la permutación. */
+    bool symmetry;          /**< Modo de simetría. */
+    bool lookahead;         /**< Poda por anticipación. */
+    int lookahead_min_diff; /**< Menor diferencia verificada por la poda (0: automática). */
+    int split_depth;        /**< Profundidad de corte usada. */
+    int index;              /**< Fragmento (0..count-1). */
+    int shards;             /**< Cantidad de fragmentos. */
+    uint64_t tasks;         /**< Prefijos explorados por el fragmento. */
+    uint64_t total_tasks;   /**< Prefijos de todos los fragmentos. */
+    uint64_t count;         /**< Permutaciones gráciles del fragmento. */
+    uint64_t nodes;         /**< Nodos visitados por el fragmento. */
+} shard_result_t;
+
+/**
+ * @brief Escribe el resultado de un fragmento (archivo temporal + rename).
+ * @param path Ruta del archivo.
+ * @param r Resultado.
+ * @return true si se escribió.
+ */
+bool shard_save(const char *path, const shard_result_t *r);
+
+/**
+ * @brief Lee el resultado de un fragmento.
+ * @param path Ruta del archivo.
+ * @param r Resultado leído.
+ * @return true si el archivo tiene todos los campos.
+ */
+bool shard_load(const char *path, shard_result_t *r);
+
+/**
+ * @brief Valida y combina los resultados de todos los fragmentos.
+ *
+ * @param paths Archivos de resultado.
+ * @param count Cantidad de archivos.
+ * @param total Resultado combinado (index = 0, tasks = total_tasks).
+ * @param err Flujo donde se explica el primer problema encontrado.
+ * @return true si los fragmentos son consistentes y completos.
+ */
+bool shard_merge(const char *const *paths, int count, shard_result_t *total, FILE *err);
+
+#endif // SHARD_H
@@ -0,0 +1,40 @@
+/**
+ * @file timing.h
+ * @brief Medición de tiempo con resolución de nanosegundos.
+ *
+ * Reemplaza a ftime(), cuya resolución de 1 ms hacía que todo n < 10 midiera 0 ms.
+ * El reloj de pared es CLOCK_MONOTONIC (no salta con ajustes de hora) y el
+ * contador de ciclos usa el contador de marca de tiempo del procesador cuando
+ * existe (rdtsc en x86-64, cntvct_el0 en AArch64).
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+/**
+ * @brief Tiempo monotónico actual en nanosegundos (origen arbitrario).
+ * @return Nanosegundos.
+ */
+uint64_t timing_now_ns(void);
+
+/**
+ * @brief Lectura del contador de ciclos del procesador.
+ *
+ * En arquitecturas sin contador accesible devuelve timing_now_ns().
+ *
+ * @return Ciclos (origen arbitrario).
+ */
+uint64_t timing_cycles(void);
+
+/**
+ * @brief Convierte una diferencia en nanosegundos a milisegundos.
+ * @param ns Nanosegundos.
+ * @return Milisegundos.
+ */
+static inline double timing_ns_to_ms(uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+#endif // TIMING_H
@@ -0,0 +1,110 @@
+/**
+ * @file tree.h
+ * @brief Etiquetados gráciles de árboles arbitrarios leídos como lista de aristas.
+ *
+ * Un árbol con m aristas es grácil si sus m+1 vértices pueden recibir
+ * etiquetas distintas de 0..m de modo que las diferencias |f(u) - f(v)| de las
+ * aristas sean exactamente 1..m. Una permutación grácil de 1..n es un
+ * etiquetado grácil del camino de n vértices (restando 1 a cada valor).
+ *
+ * El etiquetador generaliza el motor de máscaras: los vértices se etiquetan
+ * en un orden fijo en el que cada uno tiene a su padre ya etiquetado, y sus
+ * candidatos son etiqueta_padre ± d para cada diferencia d libre.
+ *
+ * Al contar, primero van los vértices internos, de mayor grado a menor (son
+ * los más restringidos), y después una fase de hojas: con los internos
+ * etiquetados cada diferencia libre y cada etiqueta libre debe poder unirse a
+ * algún padre con hojas pendientes, y se ramifica sobre la más restringida.
+ * Al buscar un etiquetado se alternan intentos con presupuesto de nodos entre
+ * ese orden y un recorrido en profundidad con las hojas antes que los hijos
+ * internos, que en las orugas reproduce la construcción clásica.
+ *
+ * Simetrías exactas, siempre activas:
+ * - Complemento f -> m - f: la raíz solo recibe etiquetas r <= m/2 y cada
+ *   etiquetado con 2r < m pesa 2.
+ * - Hojas hermanas: intercambiar las etiquetas de dos hojas con el mismo padre
+ *   da otro etiquetado grácil, así que cada conjunto de etiquetas de hermanas
+ *   se genera una sola vez y el conteo se multiplica por el producto de s!
+ *   (s = hojas de cada padre).
+ *
+ * La poda por anticipación es la del camino y se aplica a los vértices
+ * internos: cada diferencia libre d >= lookahead_min_diff necesita una pareja
+ * (x, x+d) con una etiqueta sin usar y la otra sin usar o de un vértice
+ * etiquetado con vecinos pendientes.
+ *
+ * Formato de entrada: una arista "u v" por línea (identificadores enteros no
+ * negativos); las líneas vacías y lo que sigue a '#' se ignoran.
+ */
+
+#ifndef TREE_H
+#define TREE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define TREE_MAX_VERTICES 64  ///< Las etiquetas 0..m caben en una máscara de 64 bits
+
+/**
+ * @struct tree_t
+ * @brief Árbol con vértices renumerados 0..vertices-1 en orden de aparición.
+ */
+typedef struct {
+    int vertices;                       /**< Cantidad de vértices (m + 1). */
+    long ids[TREE_MAX_VERTICES];        /**< Identificador original de cada vértice. */
+    int degree[TREE_MAX_VERTICES];      /**< Grado de cada vértice. */
+    uint64_t adjacent[TREE_MAX_VERTICES]; /**< Vecinos de cada vértice como máscara. */
+} tree_t;
+
+/**
+ * @struct tree_options_t
+ * @brief Opciones del etiquetador.
+ */
+typedef struct {
+    bool find;              /**< Detenerse en el primer etiquetado. */
+    bool lookahead;         /**< Activar la poda por anticipación. */
+    int lookahead_min_diff; /**< Menor diferencia verificada (0: (m+1)/2). */
+} tree_options_t;
+
+/**
+ * @struct tree_result_t
+ * @brief Resultado del etiquetador.
+ */
+typedef struct {
+    uint64_t canonical;     /**< Etiquetados salvo hojas hermanas (ponderados por complemento). */
+    uint64_t multiplier;    /**< Producto de s! de las hojas hermanas. */
+    uint64_t count;         /**< canonical * multiplier (válido si !overflow). */
+    bool overflow;          /**< El conteo total no cabe en 64 bits. */
+    uint64_t nodes;         /**< Nodos visitados. */
+    uint64_t lookahead_cuts; /**< Subárboles cortados por la poda o por la fase de hojas. */
+    int restarts;           /**< Intentos de --buscar abandonados por presupuesto. */
+    bool found;             /**< Se encontró al menos un etiquetado. */
+    int labels[TREE_MAX_VERTICES]; /**< Primer etiquetado encontrado, por vértice. */
+} tree_result_t;
+
+/**
+ * @brief Lee un árbol como lista de aristas y verifica que sea un árbol.
+ * @param path Archivo de entrada.
+ * @param t Árbol leído.
+ * @param err Flujo donde se explica el primer problema encontrado.
+ * @return true si el archivo describe un árbol de 1..TREE_MAX_VERTICES vértices.
+ */
+bool tree_load(const char *path, tree_t *t, FILE *err);
+
+/**
+ * @brief Cuenta los etiquetados gráciles del árbol o busca uno.
+ * @param t Árbol.
+ * @param opt Opciones.
+ * @param out Resultado.
+ */
+void tree_label(const tree_t *t, const tree_options_t *opt, tree_result_t *out);
+
+/**
+ * @brief Verifica que un etiquetado sea grácil.
+ * @param t Árbol.
+ * @param labels Etiqueta de cada vértice.
+ * @return true si las etiquetas son distintas, están en 0..m y las diferencias son 1..m.
+ */
+bool tree_verify(const tree_t *t, const int *labels);
+
+#endif // TREE_H
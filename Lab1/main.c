@@ -5,34 +5,112 @@
  * Este programa genera y cuenta todas las permutaciones gráciles de un conjunto
  * de números del 1 al n, asegurando que las diferencias entre elementos
  * consecutivos sean únicas y válidas.
+ *
+ * Compilación: gcc -O2 -I. main.c src/graceful.c src/parallel.c src/checkpoint.c src/batch.c
+ *              src/timing.c src/memo.c src/output.c src/kernel.c src/shard.c src/estimate.c
+ *              src/regress.c src/progress.c src/tree.c -lpthread -lm -o graceful
+ * Agregando -DGRACEFUL_STATS se compilan los contadores por profundidad (nodos
+ * expandidos, candidatos descartados, subárboles podados y hojas), que se
+ * imprimen por stderr después de cada búsqueda del motor bitmask.
+ *
+ * Uso: ./graceful [--motor clasico|bitmask|nucleo] [--hilos N] [--corte D] [--simetria]
+ *                 [--poda] [--poda-min D] [--memo MB [--memo-niveles K]] [--n N]
+ *                 [--enumerar archivo [--rango]] [--checkpoint archivo [--cada S] [--reanudar]]
+ *                 [--lote --desde A --hasta B [--repeticiones R] [--formato csv|json] [--salida archivo]]
+ *                 [--shard i/k --salida archivo] [--unir archivo...]
+ *                 [--estimar P [--cola L] [--semilla S] [--validar]]
+ *                 [--regresion [--hasta B] [--base archivo [--guardar-base]] [--tolerancia P]]
+ *                 [--progreso S] [--estado archivo] [--arbol archivo [--buscar]]
+ * - clasico: recursión original que prueba los valores 1..n en cada nivel.
+ * - bitmask: motor de máscaras de bits (src/graceful.c), por defecto.
+ * - nucleo: búsqueda completa con un núcleo sin recursión especializado para
+ *   cada n de 2 a 24 (src/kernel.c); fuera de ese rango usa el motor bitmask.
+ * - --hilos: reparte el árbol entre N hilos con robo de trabajo (src/parallel.c).
+ * - --simetria: explora una permutación por clase {p, reversa, complemento, ambas}.
+ * - --poda: corta un subárbol si alguna diferencia libre >= D (por defecto
+ *   (n+1)/2, o la dada con --poda-min) ya no tiene una pareja disponible.
+ * - --memo: tabla de transposición de MB megabytes (src/memo.c) consultada en
+ *   los nodos a los que les faltan a lo sumo K elementos.
+ * - --n: calcula un solo n sin preguntar por consola.
+ * - --enumerar: además de contar, escribe cada permutación en un archivo binario
+ *   de n bytes por registro (o de 8 bytes con su rango, con --rango) (src/output.c).
+ * - --checkpoint: guarda la frontera de la búsqueda cada S segundos (y al recibir
+ *   SIGTERM o SIGINT); con --reanudar continúa desde el último punto guardado.
+ * - --lote: barre n = A..B sin interacción y emite conteo, tiempo, nodos y
+ *   nodos/s por n en CSV o JSON (src/batch.c).
+ * - --shard: explora solo el fragmento i de k del árbol (para repartir un n
+ *   grande entre procesos o máquinas) y guarda el resultado en el archivo de
+ *   --salida; --unir valida los k archivos y suma conteos y nodos (src/shard.c).
+ * - --estimar: con P sondeos aleatorios estima nodos, permutaciones y tiempo de
+ *   la búsqueda para --n sin hacerla (src/estimate.c); los últimos L niveles
+ *   (--cola) de cada sondeo se recorren exactos. --validar compara la
+ *   estimación con la búsqueda exacta para n <= 15.
+ * - --regresion: compuerta de regresión (src/regress.c). Verifica los conteos
+ *   conocidos de n = 1..B (por defecto 14) con la configuración elegida y, con
+ *   --base, compara nodos/s contra un CSV de --lote guardado antes; termina con
+ *   código 2 si algún conteo es incorrecto o alguna medición es más lenta que
+ *   la base en más de P% (por defecto 10). --guardar-base reescribe la base.
+ * - --progreso: cada S segundos informa por stderr el porcentaje de tareas
+ *   terminadas, los nodos/s y el tiempo restante estimado (src/progress.c);
+ *   con --estado el informe se escribe en ese archivo. La búsqueda pasa por el
+ *   reparto en tareas de --hilos aunque sea con un solo hilo.
+ * - --arbol: cuenta los etiquetados gráciles del árbol dado como lista de
+ *   aristas "u v" (src/tree.c), o con --buscar imprime el primero que encuentra.
+ *   Admite --poda y --poda-min; las simetrías de complemento y de hojas
+ *   hermanas siempre están activas.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
 #include <math.h>
 #include <time.h>
-#include <sys/timeb.h> // Biblioteca para medir tiempo en milisegundos
+#include <signal.h>
+#include <sys/time.h>
+
+#include "include/graceful.h"
+#include "include/parallel.h"
+#include "include/output.h"
+#include "include/kernel.h"
+#include "include/shard.h"
+#include "include/estimate.h"
+#include "include/checkpoint.h"
+#include "include/batch.h"
+#include "include/regress.h"
+#include "include/progress.h"
+#include "include/tree.h"
+#include "include/timing.h" // Reloj monotónico con resolución de nanosegundos
 
 #define MAX_N 50  ///< Valor máximo permitido para n
 #define MIN_N 1   ///< Valor mínimo permitido para n
+#define MEMO_LEVELS_DEFAULT 6 ///< Elementos faltantes máximos para consultar la tabla por defecto
+#define ESTIMATE_TAIL_DEFAULT 8 ///< Niveles finales exactos de cada sondeo por defecto
+#define ESTIMATE_VALIDATE_MAX_N 15 ///< Mayor n de la validación del estimador
+#define REGRESS_TO_DEFAULT 14 ///< Último n de la compuerta de regresión por defecto
+#define REGRESS_REPS_DEFAULT 3 ///< Repeticiones por n de la compuerta por defecto
+#define REGRESS_TOLERANCE_DEFAULT 10 ///< Pérdida de velocidad admitida por defecto, en %
+#define REGRESS_MIN_MS 5.0 ///< Duración mínima en la base para comparar la velocidad
+#define PROGRESS_EVERY_DEFAULT 10 ///< Segundos entre informes si solo se da --estado
+#define EXIT_REGRESSION 2 ///< Código de salida de la compuerta con fallas
+#define EXIT_INTERRUPTED 3 ///< Código de salida tras guardar un punto de control por señal
 
 int permutation[MAX_N]; ///< Arreglo para almacenar la permutación actual
 bool used[MAX_N] = {false}; ///< Arreglo para marcar los números usados
 bool diff_used[MAX_N] = {false}; ///< Arreglo para marcar las diferencias usadas
 int n; ///< Tamaño de la permutación
 int count = 0; ///< Contador de permutaciones gráciles encontradas
+uint64_t calls = 0; ///< Llamadas a generate_graceful (nodos visitados)
 
-struct timeb start_time; ///< Tiempo de inicio del programa
+uint64_t start_time; ///< Tiempo de inicio de la medición (ns)
 
 /**
- * @brief Obtiene el tiempo transcurrido desde el inicio del programa en milisegundos.
- * @return Tiempo en milisegundos.
+ * @brief Obtiene el tiempo transcurrido desde el inicio de la medición en milisegundos.
+ * @return Tiempo en milisegundos (resolución de nanosegundos).
  */
 double get_elapsed_time() {
-    struct timeb end_time;
-    ftime(&end_time);
-    return (end_time.time - start_time.time) * 1000.0 + (end_time.millitm - start_time.millitm);
+    return timing_ns_to_ms(timing_now_ns() - start_time);
 }
 
 /**
@@ -40,6 +118,7 @@ double get_elapsed_time() {
  * @param index Índice actual en la permutación.
  */
 void generate_graceful(int index) {
+    calls++;
     if (index == n) {
         count++;
         return;
@@ -68,14 +147,963 @@ void generate_graceful(int index) {
     }
 }
 
+/**
+ * @enum motor_t
+ * @brief Motores de búsqueda disponibles.
+ */
+typedef enum {
+    MOTOR_CLASICO,  ///< Recursión original (generate_graceful)
+    MOTOR_BITMASK,  ///< Motor de máscaras de bits (src/graceful.c)
+    MOTOR_NUCLEO    ///< Núcleos especializados por n (src/kernel.c)
+} motor_t;
+
+/**
+ * @struct options_t
+ * @brief Opciones de línea de comandos.
+ */
+typedef struct {
+    motor_t motor;      ///< Motor de búsqueda
+    int threads;        ///< Hilos (1: serial, 0: uno por núcleo)
+    int split_depth;    ///< Profundidad de corte del modo paralelo (0: automática)
+    bool symmetry;      ///< Búsqueda reducida por simetría (reversa + complemento)
+    bool lookahead;     ///< Poda por anticipación de diferencias grandes
+    int lookahead_min_diff;     ///< Menor diferencia verificada (0: automática)
+    int memo_mb;        ///< Megabytes de la tabla de transposición (0: desactivada)
+    int memo_levels;    ///< Elementos faltantes máximos para consultar la tabla
+    int n;              ///< n a calcular sin preguntar (0: modo interactivo)
+    const char *enumerate_path; ///< Archivo de permutaciones (NULL: solo contar)
+    bool rank;          ///< Escribir el rango de cada permutación en lugar de sus valores
+    const char *checkpoint_path; ///< Archivo de punto de control (NULL: desactivado)
+    int checkpoint_every;        ///< Segundos entre puntos de control
+    bool resume;        ///< Continuar desde el punto de control existente
+    bool batch;         ///< Modo por lotes
+    batch_config_t batch_cfg;   ///< Rango, repeticiones y formato del modo por lotes
+    const char *output_path;    ///< Archivo de salida del modo por lotes o del fragmento (NULL: stdout)
+    int shard_index;    ///< Fragmento a explorar
+    int shard_count;    ///< Cantidad de fragmentos (0: sin fragmentar)
+    const char *const *merge_paths; ///< Resultados de fragmentos a combinar (NULL: no combinar)
+    int merge_count;    ///< Cantidad de archivos a combinar
+    int estimate_probes;        ///< Sondeos del estimador (0: no estimar)
+    int estimate_tail;  ///< Niveles finales de cada sondeo recorridos exactos
+    int seed;           ///< Semilla del estimador
+    bool validate_estimate;     ///< Comparar el estimador con la búsqueda exacta
+    bool regress;       ///< Compuerta de regresión
+    const char *baseline_path;  ///< Archivo base de la compuerta (NULL: solo verificar conteos)
+    bool update_baseline;       ///< Reescribir la base con la medición actual
+    int tolerance_pct;  ///< Pérdida de velocidad admitida por la compuerta, en %
+    int progress_every; ///< Segundos entre informes de progreso (0: sin informe)
+    const char *status_path;    ///< Archivo de estado del progreso (NULL: stderr)
+    const char *tree_path;      ///< Lista de aristas del árbol a etiquetar (NULL: caminos)
+    bool tree_find;     ///< Buscar un etiquetado del árbol en lugar de contarlos
+} options_t;
+
+/**
+ * @struct run_result_t
+ * @brief Resultado de una búsqueda con el motor elegido.
+ */
+typedef struct {
+    uint64_t count;     ///< Permutaciones gráciles encontradas
+    uint64_t nodes;     ///< Nodos visitados
+    uint64_t cuts;      ///< Subárboles cortados por la poda por anticipación
+    memo_table_t memo;  ///< Estadísticas de la tabla de transposición
+    graceful_parallel_result_t parallel; ///< Detalle del modo paralelo (si se usó)
+#ifdef GRACEFUL_STATS
+    graceful_stats_t stats; ///< Contadores por profundidad (solo motor bitmask)
+#endif
+} run_result_t;
+
+static volatile sig_atomic_t checkpoint_request = 0; ///< Pide un punto de control al motor
+static volatile sig_atomic_t stop_request = 0;       ///< Terminar después del punto de control
+
+/**
+ * @brief Manejador de SIGALRM: pide un punto de control periódico.
+ * @param sig Señal recibida.
+ */
+static void on_alarm(int sig) {
+    (void)sig;
+    checkpoint_request = 1;
+}
+
+/**
+ * @brief Manejador de SIGTERM/SIGINT: guarda un punto de control y termina.
+ * @param sig Señal recibida.
+ */
+static void on_terminate(int sig) {
+    (void)sig;
+    stop_request = 1;
+    checkpoint_request = 1;
+}
+
+/**
+ * @brief Convierte un argumento a entero no negativo.
+ * @param text Texto a convertir.
+ * @param value Valor convertido.
+ * @return true si el texto es un entero válido >= 0.
+ */
+static bool parse_int(const char *text, int *value) {
+    char *end;
+    long v = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || v < 0 || v > 1000000) {
+        return false;
+    }
+    *value = (int)v;
+    return true;
+}
+
+/**
+ * @brief Imprime la ayuda de uso.
+ * @param prog Nombre del ejecutable.
+ */
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [--motor clasico|bitmask|nucleo] [--hilos N] [--corte D] [--simetria]\n"
+            "          [--poda] [--poda-min D] [--memo MB [--memo-niveles K]] [--n N]\n"
+            "          [--enumerar archivo [--rango]] [--checkpoint archivo [--cada S] [--reanudar]]\n"
+            "          [--lote --desde A --hasta B [--repeticiones R] [--formato csv|json] [--salida archivo]]\n"
+            "          [--shard i/k --salida archivo] [--unir archivo...]\n"
+            "          [--estimar P [--cola L] [--semilla S] [--validar]]\n"
+            "          [--regresion [--hasta B] [--base archivo [--guardar-base]] [--tolerancia P]]\n"
+            "          [--progreso S] [--estado archivo] [--arbol archivo [--buscar]]\n"
+            "  --motor       motor de búsqueda (por defecto bitmask)\n"
+            "  --hilos       hilos de trabajo, 0 = uno por núcleo (por defecto 1)\n"
+            "  --corte       profundidad de corte en prefijos, 0 = automática\n"
+            "  --simetria    explora un representante por clase de reversa/complemento\n"
+            "  --poda        corta ramas donde una diferencia grande ya no es realizable\n"
+            "  --poda-min    menor diferencia verificada por --poda (por defecto (n+1)/2)\n"
+            "  --memo        megabytes de la tabla de transposición (por defecto 0, desactivada)\n"
+            "  --memo-niveles  consulta la tabla si faltan a lo sumo K elementos (por defecto %d)\n"
+            "  --n           calcula un solo n sin preguntar\n"
+            "  --enumerar    escribe cada permutación en el archivo (n bytes por registro)\n"
+            "  --rango       con --enumerar, escribe el rango de 8 bytes (n <= %d)\n"
+            "  --checkpoint  guarda la frontera de la búsqueda en el archivo\n"
+            "  --cada        segundos entre puntos de control (por defecto 60)\n"
+            "  --reanudar    continúa desde el punto de control del archivo\n"
+            "  --lote        barre n = desde..hasta sin interacción\n"
+            "  --repeticiones  ejecuciones por n, hasta %d (por defecto 1, o %d en --regresion; se reporta la mediana)\n"
+            "  --formato     csv o json (por defecto csv)\n"
+            "  --salida      archivo de resultados del modo por lotes o del fragmento\n"
+            "  --shard       explora solo el fragmento i (0..k-1) de k\n"
+            "  --unir        valida y suma los resultados de todos los fragmentos\n"
+            "  --estimar     estima nodos, permutaciones y tiempo con P sondeos aleatorios\n"
+            "  --cola        niveles finales de cada sondeo recorridos exactos (por defecto %d)\n"
+            "  --semilla     semilla del estimador (por defecto 1)\n"
+            "  --validar     compara el estimador con la búsqueda exacta para n <= %d\n"
+            "  --regresion   verifica los conteos conocidos hasta --hasta (por defecto %d) y compara\n"
+            "                la velocidad con --base; sale con código %d si hay fallas\n"
+            "  --base        CSV de --lote usado como referencia de velocidad\n"
+            "  --guardar-base  reescribe la base con esta medición si los conteos son correctos\n"
+            "  --tolerancia  pérdida de velocidad admitida, en %% (por defecto %d)\n"
+            "  --progreso    informa porcentaje, nodos/s y tiempo restante cada S segundos\n"
+            "  --estado      escribe el informe de progreso en el archivo (por defecto cada %d s)\n"
+            "  --arbol       cuenta los etiquetados gráciles del árbol (una arista \"u v\" por línea)\n"
+            "  --buscar      con --arbol, se detiene en el primer etiquetado y lo imprime\n",
+            prog, MEMO_LEVELS_DEFAULT, PERM_RANK_MAX_N, BATCH_MAX_REPS, REGRESS_REPS_DEFAULT, ESTIMATE_TAIL_DEFAULT,
+            ESTIMATE_VALIDATE_MAX_N, REGRESS_TO_DEFAULT, EXIT_REGRESSION, REGRESS_TOLERANCE_DEFAULT,
+            PROGRESS_EVERY_DEFAULT);
+}
+
+/**
+ * @brief Lee las opciones de línea de comandos.
+ * @return true si las opciones son válidas.
+ */
+static bool parse_options(int argc, char *argv[], options_t *opt) {
+    opt->motor = MOTOR_BITMASK;
+    opt->threads = 1;
+    opt->split_depth = 0;
+    opt->symmetry = false;
+    opt->lookahead = false;
+    opt->lookahead_min_diff = 0;
+    opt->memo_mb = 0;
+    opt->memo_levels = MEMO_LEVELS_DEFAULT;
+    opt->n = 0;
+    opt->enumerate_path = NULL;
+    opt->rank = false;
+    opt->checkpoint_path = NULL;
+    opt->checkpoint_every = 60;
+    opt->resume = false;
+    opt->batch = false;
+    opt->batch_cfg = (batch_config_t){ .from = 0, .to = 0, .reps = 0, .format = BATCH_CSV, .label = NULL };
+    opt->output_path = NULL;
+    opt->shard_index = 0;
+    opt->shard_count = 0;
+    opt->merge_paths = NULL;
+    opt->merge_count = 0;
+    opt->estimate_probes = 0;
+    opt->estimate_tail = ESTIMATE_TAIL_DEFAULT;
+    opt->seed = 1;
+    opt->validate_estimate = false;
+    opt->regress = false;
+    opt->baseline_path = NULL;
+    opt->update_baseline = false;
+    opt->tolerance_pct = REGRESS_TOLERANCE_DEFAULT;
+    opt->progress_every = 0;
+    opt->status_path = NULL;
+    opt->tree_path = NULL;
+    opt->tree_find = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--simetria") == 0) {
+            opt->symmetry = true;
+            continue;
+        }
+        if (strcmp(arg, "--poda") == 0) {
+            opt->lookahead = true;
+            continue;
+        }
+        if (strcmp(arg, "--unir") == 0) {
+            // El resto de los argumentos son los archivos a combinar
+            opt->merge_paths = (const char *const *)&argv[i + 1];
+            opt->merge_count = argc - i - 1;
+            break;
+        }
+        if (strcmp(arg, "--validar") == 0) {
+            opt->validate_estimate = true;
+            continue;
+        }
+        if (strcmp(arg, "--rango") == 0) {
+            opt->rank = true;
+            continue;
+        }
+        if (strcmp(arg, "--reanudar") == 0) {
+            opt->resume = true;
+            continue;
+        }
+        if (strcmp(arg, "--lote") == 0) {
+            opt->batch = true;
+            continue;
+        }
+        if (strcmp(arg, "--regresion") == 0) {
+            opt->regress = true;
+            continue;
+        }
+        if (strcmp(arg, "--buscar") == 0) {
+            opt->tree_find = true;
+            continue;
+        }
+        if (strcmp(arg, "--guardar-base") == 0) {
+            opt->update_baseline = true;
+            continue;
+        }
+
+        if (strcmp(arg, "--motor") == 0 && value) {
+            if (strcmp(value, "clasico") == 0) {
+                opt->motor = MOTOR_CLASICO;
+            } else if (strcmp(value, "bitmask") == 0) {
+                opt->motor = MOTOR_BITMASK;
+            } else if (strcmp(value, "nucleo") == 0) {
+                opt->motor = MOTOR_NUCLEO;
+            } else {
+                fprintf(stderr, "Motor desconocido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--hilos") == 0 && value) {
+            if (!parse_int(value, &opt->threads)) {
+                fprintf(stderr, "Cantidad de hilos inválida: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--corte") == 0 && value) {
+            if (!parse_int(value, &opt->split_depth)) {
+                fprintf(stderr, "Profundidad de corte inválida: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--poda-min") == 0 && value) {
+            if (!parse_int(value, &opt->lookahead_min_diff) || opt->lookahead_min_diff < 1
+                || opt->lookahead_min_diff > GRACEFUL_MAX_N) {
+                fprintf(stderr, "Diferencia mínima de poda inválida: %s\n", value);
+                return false;
+            }
+            opt->lookahead = true;
+        } else if (strcmp(arg, "--memo") == 0 && value) {
+            if (!parse_int(value, &opt->memo_mb) || opt->memo_mb > 65536) {
+                fprintf(stderr, "Tamaño de tabla inválido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--memo-niveles") == 0 && value) {
+            if (!parse_int(value, &opt->memo_levels) || opt->memo_levels < GRACEFUL_MEMO_MIN_LEFT) {
+                fprintf(stderr, "Niveles de tabla inválidos: %s (mínimo %d)\n", value, GRACEFUL_MEMO_MIN_LEFT);
+                return false;
+            }
+        } else if (strcmp(arg, "--n") == 0 && value) {
+            if (!parse_int(value, &opt->n) || opt->n < MIN_N || opt->n > MAX_N) {
+                fprintf(stderr, "Valor de n inválido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--shard") == 0 && value) {
+            char extra;
+            if (sscanf(value, "%d/%d%c", &opt->shard_index, &opt->shard_count, &extra) != 2
+                || opt->shard_count < 1 || opt->shard_index < 0 || opt->shard_index >= opt->shard_count) {
+                fprintf(stderr, "Fragmento inválido: %s (use i/k con 0 <= i < k)\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--estimar") == 0 && value) {
+            if (!parse_int(value, &opt->estimate_probes) || opt->estimate_probes < 2) {
+                fprintf(stderr, "Cantidad de sondeos inválida: %s (mínimo 2)\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--cola") == 0 && value) {
+            if (!parse_int(value, &opt->estimate_tail) || opt->estimate_tail > GRACEFUL_MAX_N) {
+                fprintf(stderr, "Niveles de cola inválidos: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--semilla") == 0 && value) {
+            if (!parse_int(value, &opt->seed)) {
+                fprintf(stderr, "Semilla inválida: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--enumerar") == 0 && value) {
+            opt->enumerate_path = value;
+        } else if (strcmp(arg, "--checkpoint") == 0 && value) {
+            opt->checkpoint_path = value;
+        } else if (strcmp(arg, "--desde") == 0 && value) {
+            if (!parse_int(value, &opt->batch_cfg.from)) {
+                fprintf(stderr, "Valor de --desde inválido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--hasta") == 0 && value) {
+            if (!parse_int(value, &opt->batch_cfg.to)) {
+                fprintf(stderr, "Valor de --hasta inválido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--repeticiones") == 0 && value) {
+            if (!parse_int(value, &opt->batch_cfg.reps) || opt->batch_cfg.reps < 1) {
+                fprintf(stderr, "Cantidad de repeticiones inválida: %s\n", value);
+                return false;
+            }
+            if (opt->batch_cfg.reps > BATCH_MAX_REPS) {
+                fprintf(stderr, "Demasiadas repeticiones: %s (máximo %d)\n", value, BATCH_MAX_REPS);
+                return false;
+            }
+        } else if (strcmp(arg, "--formato") == 0 && value) {
+            if (!batch_parse_format(value, &opt->batch_cfg.format)) {
+                fprintf(stderr, "Formato desconocido: %s (use csv o json)\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--base") == 0 && value) {
+            opt->baseline_path = value;
+        } else if (strcmp(arg, "--tolerancia") == 0 && value) {
+            if (!parse_int(value, &opt->tolerance_pct) || opt->tolerance_pct < 0 || opt->tolerance_pct > 100) {
+                fprintf(stderr, "Tolerancia inválida: %s (use 0..100)\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--salida") == 0 && value) {
+            opt->output_path = value;
+        } else if (strcmp(arg, "--progreso") == 0 && value) {
+            if (!parse_int(value, &opt->progress_every) || opt->progress_every < 1) {
+                fprintf(stderr, "Intervalo de progreso inválido: %s\n", value);
+                return false;
+            }
+        } else if (strcmp(arg, "--estado") == 0 && value) {
+            opt->status_path = value;
+        } else if (strcmp(arg, "--arbol") == 0 && value) {
+            opt->tree_path = value;
+        } else if (strcmp(arg, "--cada") == 0 && value) {
+            if (!parse_int(value, &opt->checkpoint_every) || opt->checkpoint_every < 1) {
+                fprintf(stderr, "Intervalo de punto de control inválido: %s\n", value);
+                return false;
+            }
+        } else {
+            return false;
+        }
+        i++;
+    }
+
+    if (opt->motor != MOTOR_BITMASK && (opt->threads != 1 || opt->symmetry || opt->lookahead || opt->memo_mb)) {
+        fprintf(stderr, "Los motores clasico y nucleo no admiten varios hilos, simetría, poda ni tabla.\n");
+        return false;
+    }
+    if (opt->checkpoint_path && (opt->motor != MOTOR_BITMASK || opt->threads != 1)) {
+        fprintf(stderr, "Los puntos de control solo están disponibles en el motor bitmask serial.\n");
+        return false;
+    }
+    if (opt->enumerate_path && (opt->motor != MOTOR_BITMASK || opt->n == 0 || opt->memo_mb
+                                || opt->checkpoint_path || opt->batch)) {
+        fprintf(stderr, "--enumerar necesita el motor bitmask y --n, y no admite --memo, "
+                "--checkpoint ni --lote.\n");
+        return false;
+    }
+    if (opt->rank && (!opt->enumerate_path || opt->n > PERM_RANK_MAX_N)) {
+        fprintf(stderr, "--rango necesita --enumerar y n <= %d.\n", PERM_RANK_MAX_N);
+        return false;
+    }
+    if (opt->shard_count && (opt->motor != MOTOR_BITMASK || opt->n == 0 || !opt->output_path
+                             || opt->checkpoint_path || opt->batch)) {
+        fprintf(stderr, "--shard necesita el motor bitmask, --n y --salida, y no admite "
+                "--checkpoint ni --lote.\n");
+        return false;
+    }
+    if (opt->estimate_probes && (opt->motor != MOTOR_BITMASK || (opt->n == 0 && !opt->validate_estimate)
+                                 || opt->checkpoint_path || opt->batch || opt->shard_count)) {
+        fprintf(stderr, "--estimar necesita el motor bitmask y --n (o --validar), y no admite "
+                "--checkpoint, --lote ni --shard.\n");
+        return false;
+    }
+    if (opt->validate_estimate && !opt->estimate_probes) {
+        fprintf(stderr, "--validar necesita --estimar.\n");
+        return false;
+    }
+    if (opt->resume && !opt->checkpoint_path) {
+        fprintf(stderr, "--reanudar necesita --checkpoint.\n");
+        return false;
+    }
+    if (opt->checkpoint_path && !opt->resume && opt->n == 0) {
+        fprintf(stderr, "--checkpoint necesita --n (o --reanudar).\n");
+        return false;
+    }
+    if (opt->regress && (opt->batch || opt->checkpoint_path || opt->enumerate_path || opt->shard_count
+                         || opt->estimate_probes || opt->n)) {
+        fprintf(stderr, "--regresion no admite --lote, --checkpoint, --enumerar, --shard, --estimar ni --n.\n");
+        return false;
+    }
+    if (opt->regress && (opt->batch_cfg.to < 0 || opt->batch_cfg.to > REGRESS_KNOWN_MAX_N)) {
+        fprintf(stderr, "--regresion admite --hasta entre 1 y %d.\n", REGRESS_KNOWN_MAX_N);
+        return false;
+    }
+    if ((opt->baseline_path || opt->update_baseline) && !opt->regress) {
+        fprintf(stderr, "--base y --guardar-base necesitan --regresion.\n");
+        return false;
+    }
+    if (opt->update_baseline && !opt->baseline_path) {
+        fprintf(stderr, "--guardar-base necesita --base.\n");
+        return false;
+    }
+    if (opt->tree_path && (opt->motor != MOTOR_BITMASK || opt->threads != 1 || opt->symmetry || opt->memo_mb
+                           || opt->n || opt->enumerate_path || opt->checkpoint_path || opt->batch
+                           || opt->regress || opt->shard_count || opt->estimate_probes
+                           || opt->status_path || opt->progress_every)) {
+        fprintf(stderr, "--arbol solo admite --poda, --poda-min y --buscar.\n");
+        return false;
+    }
+    if (opt->tree_find && !opt->tree_path) {
+        fprintf(stderr, "--buscar necesita --arbol.\n");
+        return false;
+    }
+    if (opt->status_path && !opt->progress_every) {
+        opt->progress_every = PROGRESS_EVERY_DEFAULT;
+    }
+    if (opt->progress_every && (opt->motor != MOTOR_BITMASK || opt->checkpoint_path || opt->batch
+                                || opt->regress || opt->estimate_probes)) {
+        fprintf(stderr, "--progreso necesita el motor bitmask y no admite --checkpoint, --lote, "
+                "--regresion ni --estimar.\n");
+        return false;
+    }
+    if (opt->batch_cfg.reps == 0) {
+        opt->batch_cfg.reps = opt->regress ? REGRESS_REPS_DEFAULT : 1;
+    }
+    if (opt->regress && opt->batch_cfg.to == 0) {
+        opt->batch_cfg.to = REGRESS_TO_DEFAULT;
+    }
+    if (opt->batch) {
+        const batch_config_t *b = &opt->batch_cfg;
+        if (opt->checkpoint_path || b->from < MIN_N || b->to > MAX_N || b->from > b->to) {
+            fprintf(stderr, "--lote necesita %d <= desde <= hasta <= %d y no admite --checkpoint.\n",
+                    MIN_N, MAX_N);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Imprime el presupuesto y la tasa de aciertos de la tabla de transposición.
+ * @param memo Estadísticas de la tabla.
+ * @param mb Presupuesto de memoria en MiB.
+ */
+static void print_memo(const memo_table_t *memo, int mb) {
+    printf("Tabla de transposición: %d MiB | Consultas: %" PRIu64 " | Aciertos: %" PRIu64
+           " (%.1f%%) | Reemplazos: %" PRIu64 "\n",
+           mb, memo->probes, memo->hits,
+           memo->probes ? 100.0 * memo->hits / memo->probes : 0.0, memo->evictions);
+}
+
+/**
+ * @brief Opciones del motor bitmask a partir de las de línea de comandos.
+ * @param opt Opciones de ejecución.
+ * @return Opciones de búsqueda.
+ */
+static graceful_options_t search_options(const options_t *opt) {
+    graceful_options_t search_opt = { .symmetry = opt->symmetry, .lookahead = opt->lookahead,
+                                      .lookahead_min_diff = opt->lookahead_min_diff };
+    return search_opt;
+}
+
+/**
+ * @struct checkpoint_ctx_t
+ * @brief Datos que necesita la función de guardado.
+ */
+typedef struct {
+    const char *path;   ///< Archivo de punto de control
+    int n;              ///< Tamaño de la permutación
+    graceful_options_t search;  ///< Opciones de la búsqueda (simetría y poda)
+} checkpoint_ctx_t;
+
+/**
+ * @brief Guarda el punto de control entregado por el motor.
+ *
+ * Si la petición vino de SIGTERM/SIGINT, termina el programa después de guardar.
+ */
+static void save_checkpoint(const graceful_prefix_t *at, uint64_t count, uint64_t nodes, void *user) {
+    const checkpoint_ctx_t *ctx = user;
+    checkpoint_t cp = { .n = ctx->n, .symmetry = ctx->search.symmetry, .lookahead = ctx->search.lookahead,
+                        .lookahead_min_diff = ctx->search.lookahead_min_diff, .done = false,
+                        .at = *at, .count = count, .nodes = nodes };
+
+    if (!checkpoint_save(ctx->path, &cp)) {
+        fprintf(stderr, "No se pudo escribir el punto de control %s\n", ctx->path);
+    }
+    if (stop_request) {
+        fprintf(stderr, "Punto de control guardado en %s; use --reanudar para continuar.\n", ctx->path);
+        exit(EXIT_INTERRUPTED);
+    }
+}
+
+/**
+ * @brief Ejecuta una búsqueda con puntos de control periódicos.
+ * @param opt Opciones de ejecución.
+ * @return Código de salida.
+ */
+static int run_checkpointed(const options_t *opt) {
+    checkpoint_t cp;
+    bool resuming = false;
+
+    if (opt->resume && checkpoint_load(opt->checkpoint_path, &cp)) {
+        if (opt->n != 0 && opt->n != cp.n) {
+            fprintf(stderr, "El punto de control es para n = %d, no %d.\n", cp.n, opt->n);
+            return 1;
+        }
+        if (cp.done) {
+            printf("Número de permutaciones gráciles para n = %d: %" PRIu64 "\n", cp.n, cp.count);
+            printf("Nodos visitados: %" PRIu64 " (ejecución ya terminada)\n", cp.nodes);
+            return 0;
+        }
+        resuming = true;
+    } else if (opt->resume && opt->n == 0) {
+        fprintf(stderr, "No hay un punto de control válido en %s\n", opt->checkpoint_path);
+        return 1;
+    }
+
+    // Al reanudar, n, la simetría y la poda salen del archivo
+    checkpoint_ctx_t ctx = { opt->checkpoint_path, opt->n, search_options(opt) };
+    if (resuming) {
+        ctx.n = cp.n;
+        ctx.search = (graceful_options_t){ .symmetry = cp.symmetry, .lookahead = cp.lookahead,
+                                           .lookahead_min_diff = cp.lookahead_min_diff };
+    }
+    graceful_search_t search;
+    graceful_search_init(&search, ctx.n, &ctx.search);
+    graceful_set_checkpoint(&search, &checkpoint_request, save_checkpoint, &ctx);
+
+    memo_table_t memo = {0};
+    if (opt->memo_mb) {
+        if (!memo_init(&memo, (size_t)opt->memo_mb << 20)) {
+            fprintf(stderr, "No se pudo reservar la tabla de transposición.\n");
+            return 1;
+        }
+        graceful_set_memo(&search, &memo, opt->memo_levels);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_alarm;
+    sigaction(SIGALRM, &sa, NULL);
+    sa.sa_handler = on_terminate;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    struct itimerval timer = { { opt->checkpoint_every, 0 }, { opt->checkpoint_every, 0 } };
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    start_time = timing_now_ns();
+    uint64_t total = resuming ? graceful_resume(&search, &cp.at, cp.count, cp.nodes)
+                              : graceful_count(&search);
+    double elapsed_time = get_elapsed_time();
+
+    struct itimerval off = { { 0, 0 }, { 0, 0 } };
+    setitimer(ITIMER_REAL, &off, NULL);
+
+    checkpoint_t final = { .n = ctx.n, .symmetry = ctx.search.symmetry, .lookahead = ctx.search.lookahead,
+                           .lookahead_min_diff = ctx.search.lookahead_min_diff, .done = true,
+                           .count = total, .nodes = search.nodes };
+    if (!checkpoint_save(opt->checkpoint_path, &final)) {
+        fprintf(stderr, "No se pudo escribir el punto de control %s\n", opt->checkpoint_path);
+    }
+
+    printf("Número de permutaciones gráciles para n = %d: %" PRIu64 "\n", ctx.n, total);
+    printf("Nodos visitados: %" PRIu64 "\n", search.nodes);
+    printf("Tiempo de ejecución%s: %.3f s\n", resuming ? " (desde la reanudación)" : "",
+           elapsed_time / 1000.0);
+    if (opt->memo_mb) {
+        print_memo(&memo, opt->memo_mb);
+        memo_free(&memo);
+    }
+    return 0;
+}
+
+/**
+ * @brief Cuenta las permutaciones gráciles de tamaño n con el motor elegido.
+ * @param n_value Tamaño de la permutación.
+ * @param opt Opciones de ejecución.
+ * @param output Destino de las permutaciones (NULL: solo contar).
+ * @param result Conteo, nodos y detalle del modo paralelo.
+ * @return true si la búsqueda terminó.
+ */
+static bool run_search(int n_value, const options_t *opt, perm_sink_t *output, run_result_t *result) {
+    memset(result, 0, sizeof(*result));
+
+    if (opt->motor == MOTOR_CLASICO) {
+        n = n_value;
+        count = 0; // Reinicia el contador de permutaciones
+        calls = 0;
+        generate_graceful(0);
+        result->count = (uint64_t)count;
+        result->nodes = calls;
+        return true;
+    }
+
+    if (opt->motor == MOTOR_NUCLEO && graceful_kernel_count(n_value, &result->count, &result->nodes)) {
+        return true;
+    }
+
+    graceful_options_t search_opt = search_options(opt);
+
+    // El progreso se mide por tareas terminadas, así que también el caso serial usa el reparto
+    if (opt->threads != 1 || opt->shard_count || opt->progress_every) {
+        progress_t progress;
+        graceful_parallel_config_t cfg = { opt->threads, opt->split_depth, search_opt,
+                                           (size_t)opt->memo_mb << 20, opt->memo_levels, output,
+                                           opt->shard_index, opt->shard_count, NULL };
+        if (opt->progress_every && progress_start(&progress, n_value, opt->progress_every, opt->status_path)) {
+            cfg.progress = &progress;
+        }
+        bool ok = graceful_count_parallel(n_value, &cfg, &result->parallel);
+        if (cfg.progress) {
+            progress_stop(&progress);
+        }
+        if (!ok) {
+            fprintf(stderr, "No se pudo ejecutar el modo paralelo.\n");
+            return false;
+        }
+        result->count = result->parallel.count;
+        result->nodes = result->parallel.nodes;
+        result->cuts = result->parallel.lookahead_cuts;
+        result->memo = result->parallel.memo;
+#ifdef GRACEFUL_STATS
+        result->stats = result->parallel.stats;
+#endif
+        return true;
+    }
+
+    graceful_search_t search;
+    graceful_search_init(&search, n_value, &search_opt);
+    memo_table_t memo = {0};
+    if (opt->memo_mb) {
+        if (!memo_init(&memo, (size_t)opt->memo_mb << 20)) {
+            fprintf(stderr, "No se pudo reservar la tabla de transposición.\n");
+            return false;
+        }
+        graceful_set_memo(&search, &memo, opt->memo_levels);
+    }
+    perm_writer_t writer = {0};
+    if (output) {
+        if (!perm_writer_init(&writer, output, PERM_WRITER_BUFFER)) {
+            fprintf(stderr, "No se pudo reservar el búfer de salida.\n");
+            return false;
+        }
+        graceful_set_leaf(&search, perm_writer_put, &writer);
+    }
+    result->count = graceful_count(&search);
+    perm_writer_free(&writer);
+    result->nodes = search.nodes;
+    result->cuts = search.lookahead_cuts;
+    result->memo = memo;
+    memo_free(&memo);
+#ifdef GRACEFUL_STATS
+    result->stats = search.stats;
+#endif
+    return true;
+}
+
+/**
+ * @brief Imprime los contadores por profundidad si se compilaron.
+ * @param n_value Tamaño de la permutación.
+ * @param opt Opciones de ejecución.
+ * @param result Resultado de la búsqueda.
+ */
+static void print_stats(int n_value, const options_t *opt, const run_result_t *result) {
+#ifdef GRACEFUL_STATS
+    if (opt->motor == MOTOR_BITMASK) {
+        fprintf(stderr, "Instrumentación para n = %d:\n", n_value);
+        graceful_stats_print(&result->stats, n_value, stderr);
+    }
+#else
+    (void)n_value;
+    (void)opt;
+    (void)result;
+#endif
+}
+
+/**
+ * @brief Adaptador de run_search() para el modo por lotes.
+ */
+static bool run_batch_sample(int n_value, batch_sample_t *out, void *user) {
+    run_result_t result;
+    if (!run_search(n_value, user, NULL, &result)) {
+        return false;
+    }
+    print_stats(n_value, user, &result);
+    out->count = result.count;
+    out->nodes = result.nodes;
+    out->cuts = result.cuts;
+    out->memo_probes = result.memo.probes;
+    out->memo_hits = result.memo.hits;
+    return true;
+}
+
+/**
+ * @brief Arma la etiqueta de la configuración y fija la verificación de nodos del modo por lotes.
+ * @param opt Opciones de ejecución.
+ * @param label Búfer de la etiqueta (debe vivir mientras se use batch_cfg).
+ * @param size Tamaño de @p label.
+ */
+static void set_batch_label(options_t *opt, char *label, size_t size) {
+    // Nombre de la configuración para la columna engine, p. ej. "bitmask+simetria+poda+4hilos"
+    static const char *const motor_names[] = { "clasico", "bitmask", "nucleo" };
+    int len = snprintf(label, size, "%s%s%s%s", motor_names[opt->motor],
+                       opt->symmetry ? "+simetria" : "", opt->lookahead ? "+poda" : "",
+                       opt->memo_mb ? "+memo" : "");
+    if (opt->threads != 1) {
+        snprintf(label + len, size - (size_t)len, "+%dhilos", opt->threads);
+    }
+    opt->batch_cfg.label = label;
+    // Con una tabla por hilo los nodos visitados dependen de qué hilo corre cada tarea
+    opt->batch_cfg.check_nodes = !(opt->memo_mb && opt->threads != 1);
+}
+
+/**
+ * @brief Ejecuta el modo por lotes.
+ * @param opt Opciones de ejecución.
+ * @return Código de salida.
+ */
+static int run_batch(options_t *opt) {
+    char label[64];
+    set_batch_label(opt, label, sizeof(label));
+
+    FILE *out = stdout;
+    if (opt->output_path) {
+        out = fopen(opt->output_path, "w");
+        if (!out) {
+            fprintf(stderr, "No se pudo abrir %s\n", opt->output_path);
+            return 1;
+        }
+    }
+
+    bool ok = batch_run(&opt->batch_cfg, run_batch_sample, opt, out);
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Ejecuta la compuerta de regresión.
+ * @param opt Opciones de ejecución.
+ * @return 0 si pasa, EXIT_REGRESSION si hay fallas, 1 si no se pudo ejecutar.
+ */
+static int run_regress(options_t *opt) {
+    char label[64];
+    set_batch_label(opt, label, sizeof(label));
+
+    regress_config_t cfg = {
+        .to = opt->batch_cfg.to,
+        .baseline_path = opt->baseline_path,
+        .update = opt->update_baseline,
+        .tolerance = opt->tolerance_pct / 100.0,
+        .min_ms = REGRESS_MIN_MS,
+    };
+    printf("Compuerta de regresión: %s, n = 1..%d, %d repeticiones\n", label, cfg.to, opt->batch_cfg.reps);
+    int failures = regress_run(&opt->batch_cfg, &cfg, run_batch_sample, opt, stdout);
+    if (failures < 0) {
+        return 1;
+    }
+    return failures ? EXIT_REGRESSION : 0;
+}
+
+/**
+ * @brief Guarda el resultado de este fragmento en el archivo de --salida.
+ * @param opt Opciones de ejecución.
+ * @param result Resultado de la búsqueda del fragmento.
+ * @return true si se escribió.
+ */
+static bool save_shard(const options_t *opt, const run_result_t *result) {
+    shard_result_t r = {
+        .n = opt->n, .symmetry = opt->symmetry, .lookahead = opt->lookahead,
+        .lookahead_min_diff = opt->lookahead_min_diff, .split_depth = result->parallel.split_depth,
+        .index = opt->shard_index, .shards = opt->shard_count,
+        .tasks = result->parallel.tasks, .total_tasks = result->parallel.total_tasks,
+        .count = result->count, .nodes = result->nodes,
+    };
+    if (!shard_save(opt->output_path, &r)) {
+        fprintf(stderr, "No se pudo escribir %s\n", opt->output_path);
+        return false;
+    }
+    printf("Fragmento %d/%d: %zu de %zu tareas, resultado en %s\n", opt->shard_index, opt->shard_count,
+           result->parallel.tasks, result->parallel.total_tasks, opt->output_path);
+    return true;
+}
+
+/**
+ * @brief Combina los resultados de todos los fragmentos.
+ * @param opt Opciones de ejecución.
+ * @return Código de salida.
+ */
+static int run_merge(const options_t *opt) {
+    shard_result_t total;
+    if (!shard_merge(opt->merge_paths, opt->merge_count, &total, stderr)) {
+        return 1;
+    }
+    printf("Fragmentos: %d | Corte: %d | Tareas: %" PRIu64 "\n", total.shards, total.split_depth, total.tasks);
+    printf("Número de permutaciones gráciles para n = %d: %" PRIu64 "\n", total.n, total.count);
+    printf("Nodos visitados: %" PRIu64 "\n", total.nodes);
+    return 0;
+}
+
+/**
+ * @brief Cuenta o busca etiquetados gráciles del árbol de --arbol.
+ * @param opt Opciones de ejecución.
+ * @return Código de salida (1 si el árbol no se pudo leer o, con --buscar, no es grácil).
+ */
+static int run_tree(const options_t *opt) {
+    tree_t tree;
+    if (!tree_load(opt->tree_path, &tree, stderr)) {
+        return 1;
+    }
+
+    tree_options_t tree_opt = { opt->tree_find, opt->lookahead, opt->lookahead_min_diff };
+    tree_result_t result;
+    uint64_t start = timing_now_ns();
+    tree_label(&tree, &tree_opt, &result);
+    double ms = timing_ns_to_ms(timing_now_ns() - start);
+
+    printf("Árbol %s: %d vértices, %d aristas\n", opt->tree_path, tree.vertices, tree.vertices - 1);
+    if (opt->tree_find) {
+        if (!result.found) {
+            printf("El árbol no tiene etiquetado grácil.\n");
+        } else {
+            printf("Etiquetado grácil (vértice: etiqueta)%s:\n",
+                   tree_verify(&tree, result.labels) ? "" : " [NO VERIFICA]");
+            for (int v = 0; v < tree.vertices; v++) {
+                printf("  %ld: %d\n", tree.ids[v], result.labels[v]);
+            }
+        }
+    } else if (result.overflow) {
+        printf("Etiquetados gráciles: %" PRIu64 " canónicos x %" PRIu64 " (no cabe en 64 bits)\n",
+               result.canonical, result.multiplier);
+    } else {
+        printf("Etiquetados gráciles: %" PRIu64 " (%" PRIu64 " canónicos x %" PRIu64 " por hojas hermanas)\n",
+               result.count, result.canonical, result.multiplier);
+    }
+    printf("Nodos visitados: %" PRIu64 " | Podados: %" PRIu64 "", result.nodes, result.lookahead_cuts);
+    if (opt->tree_find) {
+        printf(" | Reinicios: %d", result.restarts);
+    }
+    printf("\nTiempo de ejecución: %.3f ms\n", ms);
+    return opt->tree_find && !result.found ? 1 : 0;
+}
+
+/**
+ * @brief Estima la búsqueda para --n o valida el estimador contra búsquedas exactas.
+ * @param opt Opciones de ejecución.
+ * @return Código de salida.
+ */
+static int run_estimate(const options_t *opt) {
+    graceful_options_t search_opt = search_options(opt);
+    estimate_t est;
+
+    if (!opt->validate_estimate) {
+        graceful_estimate(opt->n, &search_opt, opt->estimate_probes, opt->estimate_tail,
+                          (uint64_t)opt->seed, &est);
+        printf("Estimación para n = %d con %d sondeos (intervalos del 95%%):\n", opt->n, est.probes);
+        printf("  Nodos: %.4g ± %.2g\n", est.nodes, est.nodes_ci);
+        if (est.count_hits > 0) {
+            printf("  Permutaciones gráciles: %.4g ± %.2g (%d sondeos llegaron a una hoja)\n",
+                   est.count, est.count_ci, est.count_hits);
+        } else {
+            // Sin hojas la media vale 0 con varianza 0: no es una estimación
+            printf("  Permutaciones gráciles: sin estimar (ningún sondeo llegó a una hoja; "
+                   "subir --cola o --estimar)\n");
+        }
+        printf("  Tiempo serial: %.4g ± %.2g s (%.3g nodos/s medidos con n = %d)\n",
+               est.seconds, est.seconds_ci, est.rate, est.rate_n);
+        if (opt->threads > 1) {
+            printf("  Con %d hilos (reparto ideal): %.4g s\n", opt->threads, est.seconds / opt->threads);
+        }
+        return 0;
+    }
+
+    int inside = 0, total = 0;
+    printf("%3s %12s %22s %14s %22s %8s\n", "n", "conteo", "estimado", "nodos", "estimado", "err.nod");
+    for (int n_value = MIN_N + 1; n_value <= ESTIMATE_VALIDATE_MAX_N; n_value++) {
+        graceful_estimate(n_value, &search_opt, opt->estimate_probes, opt->estimate_tail,
+                          (uint64_t)opt->seed, &est);
+        graceful_search_t search;
+        graceful_search_init(&search, n_value, &search_opt);
+        uint64_t exact = graceful_count(&search);
+
+        bool ok = fabs(est.nodes - (double)search.nodes) <= est.nodes_ci
+               && fabs(est.count - (double)exact) <= est.count_ci;
+        inside += ok;
+        total++;
+        printf("%3d %12" PRIu64 " %12.1f ± %7.1f %14" PRIu64 " %12.4g ± %7.2g %7.2f%%%s\n", n_value, exact,
+               est.count, est.count_ci, search.nodes, est.nodes, est.nodes_ci,
+               100.0 * (est.nodes - (double)search.nodes) / (double)search.nodes,
+               ok ? "" : (est.count_hits > 0 ? "  *" : "  * (conteo sin estimar)"));
+    }
+    printf("Valores exactos dentro del intervalo: %d de %d (* = fuera)\n", inside, total);
+    return 0;
+}
+
 /**
  * @brief Función principal del programa.
+ * @param argc Cantidad de argumentos.
+ * @param argv Argumentos de línea de comandos.
  * @return Código de salida.
  */
-int main() {
+int main(int argc, char *argv[]) {
+    options_t opt;
+    if (!parse_options(argc, argv, &opt)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (opt.merge_paths) {
+        return run_merge(&opt);
+    }
+    if (opt.tree_path) {
+        return run_tree(&opt);
+    }
+    if (opt.estimate_probes) {
+        return run_estimate(&opt);
+    }
+    if (opt.checkpoint_path) {
+        return run_checkpointed(&opt);
+    }
+    if (opt.batch) {
+        return run_batch(&opt);
+    }
+    if (opt.regress) {
+        return run_regress(&opt);
+    }
+
     while (true) {
-        printf("Ingrese el valor de n (o 0 para salir): ");
-        scanf("%d", &n);
+        if (opt.n != 0) {
+            n = opt.n;
+        } else {
+            printf("Ingrese el valor de n (o 0 para salir): ");
+            scanf("%d", &n);
+        }
 
         if (n == 0) {
             printf("Saliendo del programa.\n");
@@ -91,17 +1119,54 @@ int main() {
             continue; // Pide otro valor de `n`
         }
 
-        ftime(&start_time); // Captura el tiempo inicial
-        count = 0; // Reinicia el contador de permutaciones
-        generate_graceful(0);
+        perm_sink_t sink;
+        if (opt.enumerate_path && !perm_sink_open(&sink, opt.enumerate_path, n, opt.rank)) {
+            fprintf(stderr, "No se pudo crear %s\n", opt.enumerate_path);
+            return 1;
+        }
+
+        start_time = timing_now_ns(); // Captura el tiempo inicial
+        run_result_t result;
+        if (!run_search(n, &opt, opt.enumerate_path ? &sink : NULL, &result)) {
+            return 1;
+        }
         double elapsed_time = get_elapsed_time();
 
-        printf("Número de permutaciones gráciles para n = %d: %d\n", n, count);
+        if (opt.enumerate_path) {
+            uint64_t records = sink.records;
+            if (!perm_sink_close(&sink) || records != result.count) {
+                fprintf(stderr, "Error al escribir %s\n", opt.enumerate_path);
+                return 1;
+            }
+            printf("Permutaciones escritas en %s: %" PRIu64 " (%d bytes por registro)\n",
+                   opt.enumerate_path, records, opt.rank ? 8 : n);
+        }
+
+        if (opt.shard_count && !save_shard(&opt, &result)) {
+            return 1;
+        }
+        if (opt.threads != 1 || opt.shard_count) {
+            printf("Hilos: %d | Corte: %d | Tareas: %zu | Robos: %zu\n", result.parallel.threads,
+                   result.parallel.split_depth, result.parallel.tasks, result.parallel.steals);
+        }
+        printf("Número de permutaciones gráciles para n = %d: %" PRIu64 "\n", n, result.count);
+        if (opt.lookahead) {
+            printf("Nodos visitados: %" PRIu64 " | Podas por anticipación: %" PRIu64 "\n",
+                   result.nodes, result.cuts);
+        }
+        if (opt.memo_mb) {
+            print_memo(&result.memo, opt.memo_mb);
+        }
         printf("Tiempo de ejecución: %.3f ms\n", elapsed_time); // Imprime en milisegundos
         printf("Tiempo de ejecución: %.3f s\n", elapsed_time / 1000.0); // Imprime en segundos
         printf("Tiempo de ejecución: %.3f min\n", elapsed_time / 60000.0); // Imprime en minutos
         printf("Tiempo de ejecución: %.3f h\n", elapsed_time / 3600000.0); // Imprime en horas
+        print_stats(n, &opt, &result);
+
+        if (opt.n != 0) {
+            break; // Un solo n pedido por línea de comandos
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
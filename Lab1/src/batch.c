@@ -0,0 +1,114 @@
+/**
+ * @file batch.c
+ * @brief Implementación del modo por lotes.
+ */
+
+#include "include/batch.h"
+#include "include/timing.h"
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/**
+ * @brief Comparador para qsort de double.
+ */
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+bool batch_parse_format(const char *name, batch_format_t *format) {
+    if (strcmp(name, "csv") == 0) {
+        *format = BATCH_CSV;
+    } else if (strcmp(name, "json") == 0) {
+        *format = BATCH_JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool batch_measure(const batch_config_t *cfg, int n, batch_run_fn run, void *user, batch_row_t *row) {
+    double times[BATCH_MAX_REPS];
+    double cycles[BATCH_MAX_REPS];
+    int reps = cfg->reps < 1 ? 1 : (cfg->reps > BATCH_MAX_REPS ? BATCH_MAX_REPS : cfg->reps);
+    batch_sample_t reference = {0};
+
+    for (int r = 0; r < reps; r++) {
+        batch_sample_t sample;
+        uint64_t start_cycles = timing_cycles();
+        uint64_t start = timing_now_ns();
+        if (!run(n, &sample, user)) {
+            fprintf(stderr, "Falló la ejecución para n = %d\n", n);
+            return false;
+        }
+        times[r] = timing_ns_to_ms(timing_now_ns() - start);
+        cycles[r] = (double)(timing_cycles() - start_cycles);
+
+        if (r == 0) {
+            reference = sample;
+        } else if (sample.count != reference.count
+                   || (cfg->check_nodes && (sample.nodes != reference.nodes || sample.cuts != reference.cuts))) {
+            fprintf(stderr, "Resultados distintos entre repeticiones para n = %d\n", n);
+            return false;
+        }
+    }
+
+    qsort(times, (size_t)reps, sizeof(times[0]), compare_double);
+    qsort(cycles, (size_t)reps, sizeof(cycles[0]), compare_double);
+
+    row->n = n;
+    row->reps = reps;
+    row->sample = reference;
+    row->wall_ms = reps % 2 ? times[reps / 2] : (times[reps / 2 - 1] + times[reps / 2]) / 2.0;
+    row->wall_min_ms = times[0];
+    row->nodes_per_s = row->wall_ms > 0.0 ? reference.nodes / (row->wall_ms / 1000.0) : 0.0;
+    row->cycles_per_node = reference.nodes ? cycles[reps / 2] / (double)reference.nodes : 0.0;
+    row->memo_hit_rate = reference.memo_probes
+                       ? (double)reference.memo_hits / (double)reference.memo_probes : 0.0;
+    return true;
+}
+
+void batch_write_header(const batch_config_t *cfg, FILE *out) {
+    if (cfg->format == BATCH_CSV) {
+        fprintf(out, "engine,n,count,reps,wall_ms,wall_min_ms,nodes,nodes_per_s,cycles_per_node,cuts,memo_hit_rate\n");
+    } else {
+        fprintf(out, "[\n");
+    }
+}
+
+void batch_write_row(const batch_config_t *cfg, const batch_row_t *row, bool first, FILE *out) {
+    const batch_sample_t *s = &row->sample;
+    if (cfg->format == BATCH_CSV) {
+        fprintf(out, "%s,%d,%" PRIu64 ",%d,%.6f,%.6f,%" PRIu64 ",%.0f,%.2f,%" PRIu64 ",%.4f\n",
+                cfg->label, row->n, s->count, row->reps, row->wall_ms, row->wall_min_ms, s->nodes,
+                row->nodes_per_s, row->cycles_per_node, s->cuts, row->memo_hit_rate);
+    } else {
+        fprintf(out, "%s  {\"engine\": \"%s\", \"n\": %d, \"count\": %" PRIu64 ", \"reps\": %d, "
+                "\"wall_ms\": %.6f, \"wall_min_ms\": %.6f, \"nodes\": %" PRIu64 ", \"nodes_per_s\": %.0f, "
+                "\"cycles_per_node\": %.2f, \"cuts\": %" PRIu64 ", \"memo_hit_rate\": %.4f}",
+                first ? "" : ",\n", cfg->label, row->n, s->count, row->reps, row->wall_ms, row->wall_min_ms,
+                s->nodes, row->nodes_per_s, row->cycles_per_node, s->cuts, row->memo_hit_rate);
+    }
+    fflush(out);
+}
+
+void batch_write_footer(const batch_config_t *cfg, FILE *out) {
+    if (cfg->format == BATCH_JSON) {
+        fprintf(out, "\n]\n");
+    }
+}
+
+bool batch_run(const batch_config_t *cfg, batch_run_fn run, void *user, FILE *out) {
+    batch_write_header(cfg, out);
+    for (int n = cfg->from; n <= cfg->to; n++) {
+        batch_row_t row;
+        if (!batch_measure(cfg, n, run, user, &row)) {
+            return false;
+        }
+        batch_write_row(cfg, &row, n == cfg->from, out);
+    }
+    batch_write_footer(cfg, out);
+    return true;
+}
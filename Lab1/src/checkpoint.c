@@ -0,0 +1,171 @@
+/**
+ * @file checkpoint.c
+ * @brief Serialización de puntos de control.
+ *
+ * Formato (enteros en little-endian):
+ * | campo       | bytes |
+ * |-------------|-------|
+ * | firma "GPCK"| 4     |
+ * | versión     | 1     |
+ * | n           | 1     |
+ * | banderas    | 1     | (bit 0: simetría, bit 1: terminado, bit 2: anticipación)
+ * | profundidad | 1     |
+ * | peso        | 1     |
+ * | usados      | 8     |
+ * | dif. libres | 8     |
+ * | conteo      | 8     |
+ * | nodos       | 8     |
+ * | dif. mínima | 1     | (poda por anticipación)
+ * | reservado   | 3     |
+ * | prefijo     | profundidad |
+ * | CRC-32      | 4     |
+ */
+
+#include "include/checkpoint.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECKPOINT_VERSION 1            ///< Versión del formato
+#define CHECKPOINT_HEADER 45            ///< Bytes antes del prefijo
+#define CHECKPOINT_MAX (CHECKPOINT_HEADER + GRACEFUL_MAX_N + 4) ///< Tamaño máximo del archivo
+
+#define FLAG_SYMMETRY 0x01  ///< La búsqueda usa simetría
+#define FLAG_DONE     0x02  ///< La búsqueda terminó
+#define FLAG_LOOKAHEAD 0x04 ///< La búsqueda usa poda por anticipación
+
+/**
+ * @brief CRC-32 (polinomio reflejado 0xEDB88320) bit a bit; los archivos son diminutos.
+ */
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+        }
+    }
+    return ~crc;
+}
+
+/// Escribe un entero de @p bytes bytes en little-endian.
+static void put_le(uint8_t *p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+/// Lee un entero de @p bytes bytes en little-endian.
+static uint64_t get_le(const uint8_t *p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+bool checkpoint_save(const char *path, const checkpoint_t *cp) {
+    uint8_t buf[CHECKPOINT_MAX];
+    int depth = cp->done ? 0 : cp->at.depth;
+
+    memcpy(buf, "GPCK", 4);
+    buf[4] = CHECKPOINT_VERSION;
+    buf[5] = (uint8_t)cp->n;
+    buf[6] = (cp->symmetry ? FLAG_SYMMETRY : 0) | (cp->done ? FLAG_DONE : 0)
+             | (cp->lookahead ? FLAG_LOOKAHEAD : 0);
+    buf[7] = (uint8_t)depth;
+    buf[8] = cp->done ? 0 : cp->at.weight;
+    put_le(buf + 9, cp->done ? 0 : cp->at.used, 8);
+    put_le(buf + 17, cp->done ? 0 : cp->at.free_diffs, 8);
+    put_le(buf + 25, cp->count, 8);
+    put_le(buf + 33, cp->nodes, 8);
+    buf[41] = (uint8_t)cp->lookahead_min_diff;
+    memset(buf + 42, 0, 3); // reservado
+    memcpy(buf + CHECKPOINT_HEADER, cp->at.perm, (size_t)depth);
+    size_t len = CHECKPOINT_HEADER + (size_t)depth;
+    put_le(buf + len, crc32(buf, len), 4);
+    len += 4;
+
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return false;
+    }
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = fwrite(buf, 1, len, f) == len;
+    ok = fflush(f) == 0 && ok;
+    ok = fsync(fileno(f)) == 0 && ok;
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+bool checkpoint_load(const char *path, checkpoint_t *cp) {
+    uint8_t buf[CHECKPOINT_MAX + 1];
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    if (len < CHECKPOINT_HEADER + 4 || len > CHECKPOINT_MAX || memcmp(buf, "GPCK", 4) != 0
+        || buf[4] != CHECKPOINT_VERSION) {
+        return false;
+    }
+    if (get_le(buf + len - 4, 4) != crc32(buf, len - 4)) {
+        return false;
+    }
+
+    memset(cp, 0, sizeof(*cp));
+    cp->n = buf[5];
+    cp->symmetry = (buf[6] & FLAG_SYMMETRY) != 0;
+    cp->done = (buf[6] & FLAG_DONE) != 0;
+    cp->lookahead = (buf[6] & FLAG_LOOKAHEAD) != 0;
+    cp->lookahead_min_diff = buf[41];
+    cp->at.depth = buf[7];
+    cp->at.weight = buf[8];
+    cp->at.used = get_le(buf + 9, 8);
+    cp->at.free_diffs = get_le(buf + 17, 8);
+    cp->count = get_le(buf + 25, 8);
+    cp->nodes = get_le(buf + 33, 8);
+
+    if (cp->n < 1 || cp->n > GRACEFUL_MAX_N || len != CHECKPOINT_HEADER + (size_t)cp->at.depth + 4) {
+        return false;
+    }
+    if (cp->done) {
+        return cp->at.depth == 0;
+    }
+    if (cp->at.depth < 1 || cp->at.depth > cp->n) {
+        return false;
+    }
+    memcpy(cp->at.perm, buf + CHECKPOINT_HEADER, (size_t)cp->at.depth);
+
+    // Las máscaras deben poder reconstruirse a partir del prefijo
+    graceful_mask_t used = 0;
+    graceful_mask_t diffs = (GRACEFUL_BIT(cp->n - 1) - 1) << 1;
+    for (int i = 0; i < cp->at.depth; i++) {
+        int v = cp->at.perm[i];
+        if (v < 1 || v > cp->n || (used & GRACEFUL_BIT(v))) {
+            return false;
+        }
+        used |= GRACEFUL_BIT(v);
+        if (i > 0) {
+            int prev = cp->at.perm[i - 1];
+            int d = v > prev ? v - prev : prev - v;
+            if (!(diffs & GRACEFUL_BIT(d))) {
+                return false;
+            }
+            diffs &= ~GRACEFUL_BIT(d);
+        }
+    }
+    return used == cp->at.used && diffs == cp->at.free_diffs;
+}
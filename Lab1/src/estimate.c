@@ -0,0 +1,75 @@
+/**
+ * @file estimate.c
+ * @brief Implementación del estimador por sondeos aleatorios.
+ */
+
+#include "include/estimate.h"
+#include "include/timing.h"
+#include <math.h>
+
+#define CALIBRATION_MIN_NS 200000000u  ///< Duración mínima de la búsqueda de calibración (0.2 s)
+#define CALIBRATION_FIRST_N 8          ///< Primer n probado al calibrar
+#define Z95 1.96                       ///< Cuantil normal del intervalo del 95%
+
+/**
+ * @brief Mide los nodos por segundo del motor con búsquedas exactas crecientes.
+ *
+ * Sube n hasta que la búsqueda dure al menos CALIBRATION_MIN_NS (o llegue al
+ * n pedido) y devuelve la velocidad de la última.
+ */
+static double measure_rate(int n, const graceful_options_t *opt, int *rate_n) {
+    double rate = 0.0;
+    int cal = n < CALIBRATION_FIRST_N ? n : CALIBRATION_FIRST_N;
+
+    for (; cal <= n; cal++) {
+        graceful_search_t search;
+        graceful_search_init(&search, cal, opt);
+        uint64_t start = timing_now_ns();
+        graceful_count(&search);
+        uint64_t elapsed = timing_now_ns() - start;
+
+        rate = elapsed ? (double)search.nodes * 1e9 / (double)elapsed : 0.0;
+        *rate_n = cal;
+        if (elapsed >= CALIBRATION_MIN_NS) {
+            break;
+        }
+    }
+    return rate;
+}
+
+void graceful_estimate(int n, const graceful_options_t *opt, int probes, int tail, uint64_t seed,
+                       estimate_t *out) {
+    graceful_search_t search;
+    graceful_search_init(&search, n, opt);
+
+    uint64_t rng = seed ? seed : 0x9E3779B97F4A7C15ull;
+    double sum_nodes = 0.0, sq_nodes = 0.0;
+    double sum_count = 0.0, sq_count = 0.0;
+    int hits = 0;
+    if (probes < 2) probes = 2;
+
+    for (int i = 0; i < probes; i++) {
+        double nodes, count;
+        graceful_probe(&search, tail, &rng, &nodes, &count);
+        sum_nodes += nodes;
+        sq_nodes += nodes * nodes;
+        sum_count += count;
+        sq_count += count * count;
+        hits += count > 0.0;
+    }
+
+    double p = (double)probes;
+    double var_nodes = (sq_nodes - sum_nodes * sum_nodes / p) / (p - 1.0);
+    double var_count = (sq_count - sum_count * sum_count / p) / (p - 1.0);
+
+    out->probes = probes;
+    out->nodes = sum_nodes / p;
+    out->nodes_ci = Z95 * sqrt(var_nodes > 0.0 ? var_nodes / p : 0.0);
+    out->count = sum_count / p;
+    out->count_ci = Z95 * sqrt(var_count > 0.0 ? var_count / p : 0.0);
+    out->count_hits = hits;
+
+    out->rate = measure_rate(n, opt, &out->rate_n);
+    out->seconds = out->rate > 0.0 ? out->nodes / out->rate : 0.0;
+    out->seconds_ci = out->rate > 0.0 ? out->nodes_ci / out->rate : 0.0;
+}
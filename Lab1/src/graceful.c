@@ -0,0 +1,521 @@
+/**
+ * @file graceful.c
+ * @brief Implementación del motor de búsqueda con máscaras de bits.
+ *
+ * En vez de probar los n valores en cada nivel, se recorren solo las
+ * diferencias libres (con ctz sobre la máscara) y para cada una se intentan
+ * los dos candidatos prev-d y prev+d. El factor de ramificación pasa de n a
+ * como mucho 2 * popcount(diferencias libres), y la mayoría de esos candidatos
+ * son válidos.
+ */
+
+#include "include/graceful.h"
+#include <string.h>
+
+/**
+ * @brief Indica si un nodo no puede llevar a una permutación canónica (modo simetría).
+ *
+ * Con la diferencia n-1 aún libre, el nodo está muerto si n ya se usó, si el 1
+ * se usó y no es el último elemento, o si ya se pasó la última posición válida
+ * para n.
+ */
+static inline bool symmetry_dead(const graceful_search_t *s, int depth, int prev,
+                                 graceful_mask_t used, graceful_mask_t free_diffs) {
+    if (!(free_diffs & s->edge_bit)) {
+        return false;
+    }
+    return depth > s->edge_limit
+        || (used & GRACEFUL_BIT(s->n))
+        || ((used & GRACEFUL_BIT(1)) && prev != 1);
+}
+
+/**
+ * @brief Indica si alguna diferencia grande libre ya no puede realizarse.
+ *
+ * Los extremos disponibles son los números sin usar más el último colocado
+ * (el único usado que aún puede tener un vecino nuevo). avail & (avail >> d)
+ * tiene el bit x encendido si x y x+d están ambos disponibles.
+ */
+static inline bool lookahead_dead(const graceful_search_t *s, int prev,
+                                  graceful_mask_t used, graceful_mask_t free_diffs) {
+    graceful_mask_t avail = (s->numbers & ~used) | GRACEFUL_BIT(prev);
+    graceful_mask_t large = free_diffs & s->lookahead_mask;
+
+    while (large) {
+        int d = __builtin_ctzll(large);
+        large &= large - 1;
+        if (!(avail & (avail >> d))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Copia el camino actual a un prefijo.
+ */
+static void make_prefix(const graceful_search_t *s, int depth, graceful_mask_t used,
+                        graceful_mask_t free_diffs, graceful_prefix_t *prefix) {
+    prefix->depth = depth;
+    prefix->used = used;
+    prefix->free_diffs = free_diffs;
+    prefix->weight = (uint8_t)s->weight;
+    for (int i = 0; i < depth; i++) {
+        prefix->perm[i] = (uint8_t)s->perm[i];
+    }
+}
+
+/**
+ * @brief Entrega el punto de control pedido. Fuera de la ruta caliente.
+ */
+static __attribute__((noinline, cold)) void take_checkpoint(graceful_search_t *s, int depth,
+                                                            graceful_mask_t used,
+                                                            graceful_mask_t free_diffs) {
+    graceful_prefix_t at;
+    *s->checkpoint_flag = 0;
+    make_prefix(s, depth, used, free_diffs, &at);
+    s->checkpoint_cb(&at, s->count, s->nodes, s->checkpoint_user);
+}
+
+/**
+ * @brief Entrega la permutación actual (y en modo simetría el resto de su clase).
+ *
+ * Con peso 2 el otro representante canónico RC(p) también es una hoja, y él
+ * aporta RC y C; por eso aquí solo se agregan p y R(p).
+ */
+static __attribute__((noinline)) void emit_leaf(graceful_search_t *s) {
+    int n = s->n;
+    s->leaf_cb(s->perm, n, s->leaf_user);
+    if (!s->opt.symmetry) {
+        return;
+    }
+
+    int image[GRACEFUL_MAX_N];
+    for (int i = 0; i < n; i++) {
+        image[i] = s->perm[n - 1 - i];          // R
+    }
+    s->leaf_cb(image, n, s->leaf_user);
+    if (s->weight == 2) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        image[i] = n + 1 - s->perm[i];          // C
+    }
+    s->leaf_cb(image, n, s->leaf_user);
+    for (int i = 0; i < n; i++) {
+        image[i] = n + 1 - s->perm[n - 1 - i];  // RC
+    }
+    s->leaf_cb(image, n, s->leaf_user);
+}
+
+/**
+ * @brief Recursión principal del motor de máscaras.
+ *
+ * @param s Estado de búsqueda.
+ * @param depth Cantidad de elementos colocados.
+ * @param prev Último elemento colocado.
+ * @param used Números usados.
+ * @param free_diffs Diferencias libres.
+ */
+static void search(graceful_search_t *s, int depth, int prev,
+                   graceful_mask_t used, graceful_mask_t free_diffs) {
+    // El punto de control se toma antes de contar el nodo: al reanudar se visita de nuevo
+    if (s->checkpoint_flag && *s->checkpoint_flag) {
+        take_checkpoint(s, depth, used, free_diffs);
+    }
+
+    s->nodes++;
+    GRACEFUL_STAT_ADD(s, expanded, depth);
+
+    if (depth == s->n) {
+        GRACEFUL_STAT_LEAF(s);
+        s->count += s->weight;
+        if (s->leaf_cb) {
+            emit_leaf(s);
+        }
+        return;
+    }
+
+    if (s->opt.symmetry && symmetry_dead(s, depth, prev, used, free_diffs)) {
+        GRACEFUL_STAT_ADD(s, cut, depth);
+        return;
+    }
+
+    // Último nivel: queda un solo número y una sola diferencia, no hace falta iterar
+    if (depth == s->n - 1) {
+        int last = __builtin_ctzll(s->numbers & ~used);
+        int diff = last > prev ? last - prev : prev - last;
+        if (free_diffs == GRACEFUL_BIT(diff)) {
+            if (diff == s->n - 1) {
+                s->weight = s->edge_weight[depth];
+            }
+            s->perm[depth] = last;
+            s->nodes++;
+            GRACEFUL_STAT_ADD(s, expanded, depth + 1);
+            GRACEFUL_STAT_LEAF(s);
+            s->count += s->weight;
+            if (s->leaf_cb) {
+                emit_leaf(s);
+            }
+        } else {
+            GRACEFUL_STAT_ADD(s, rejected, depth);
+        }
+        return;
+    }
+
+    if (s->opt.lookahead && lookahead_dead(s, prev, used, free_diffs)) {
+        s->lookahead_cuts++;
+        GRACEFUL_STAT_ADD(s, cut, depth);
+        return;
+    }
+
+    // Tabla de transposición. Con la arista {1, n} ya colocada todas las hojas
+    // del subárbol pesan s->weight, así que se guarda el conteo sin ponderar;
+    // si aún está libre, el peso se fija dentro del subárbol y depende solo del estado.
+    uint64_t key = 0, count_before = 0, nodes_before = 0, weight = 1;
+    if (depth >= s->memo_from && depth <= s->memo_to) {
+        uint64_t stored;
+        key = memo_key(used, prev);
+        weight = (free_diffs & s->edge_bit) ? 1 : s->weight;
+        if (memo_probe(s->memo, key, free_diffs, &stored)) {
+            s->count += stored * weight;
+            return;
+        }
+        count_before = s->count;
+        nodes_before = s->nodes;
+    }
+
+    graceful_mask_t pending = free_diffs;
+    while (pending) {
+        int d = __builtin_ctzll(pending);
+        pending &= pending - 1;
+        graceful_mask_t rest = free_diffs & ~GRACEFUL_BIT(d);
+
+        // Los dos candidatos de d = n-1 forman la arista {1, n} en la misma posición
+        if (d == s->n - 1) {
+            s->weight = s->edge_weight[depth];
+        }
+
+        int next = prev - d;
+        if (next >= 1 && !(used & GRACEFUL_BIT(next))) {
+            s->perm[depth] = next;
+            search(s, depth + 1, next, used | GRACEFUL_BIT(next), rest);
+        } else {
+            GRACEFUL_STAT_ADD(s, rejected, depth);
+        }
+
+        next = prev + d;
+        if (next <= s->n && !(used & GRACEFUL_BIT(next))) {
+            s->perm[depth] = next;
+            search(s, depth + 1, next, used | GRACEFUL_BIT(next), rest);
+        } else {
+            GRACEFUL_STAT_ADD(s, rejected, depth);
+        }
+    }
+
+    if (key) {
+        memo_store(s->memo, key, free_diffs, (s->count - count_before) / weight, s->nodes - nodes_before);
+    }
+}
+
+void graceful_search_init(graceful_search_t *s, int n, const graceful_options_t *opt) {
+    memset(s, 0, sizeof(*s));
+    s->n = n;
+    if (opt) {
+        s->opt = *opt;
+    }
+    s->numbers = (GRACEFUL_BIT(n) - 1) << 1;      // bits 1..n
+    s->diffs = (GRACEFUL_BIT(n - 1) - 1) << 1;    // bits 1..n-1
+
+    // Con n = 1 no hay aristas: la única permutación es su propia clase
+    if (n < 2) {
+        s->opt.symmetry = false;
+    }
+
+    int min_diff = s->opt.lookahead_min_diff > 0 ? s->opt.lookahead_min_diff : (n + 1) / 2;
+    if (min_diff < 1) min_diff = 1;
+    s->lookahead_mask = s->diffs & ~(GRACEFUL_BIT(min_diff) - 1);  // diferencias >= min_diff
+
+    s->memo_from = n + 1; // sin tabla de transposición
+    s->memo_to = 0;
+
+    s->edge_bit = n >= 2 ? GRACEFUL_BIT(n - 1) : 0;
+    s->edge_limit = (n - 2) / 2 + 1;
+    s->weight = 1;
+    for (int depth = 0; depth <= n; depth++) {
+        // depth es la posición de n; el 1 está en depth - 1
+        if (!s->opt.symmetry) {
+            s->edge_weight[depth] = 1;
+        } else {
+            s->edge_weight[depth] = 2 * (depth - 1) == n - 2 ? 2 : 4;
+        }
+    }
+}
+
+void graceful_search_prefix(graceful_search_t *s, const graceful_prefix_t *prefix) {
+    for (int i = 0; i < prefix->depth; i++) {
+        s->perm[i] = prefix->perm[i];
+    }
+    s->weight = prefix->weight;
+    search(s, prefix->depth, prefix->perm[prefix->depth - 1], prefix->used, prefix->free_diffs);
+}
+
+/**
+ * @brief Recorre el árbol hasta la profundidad objetivo y entrega cada prefijo.
+ *
+ * Usa el mismo orden de candidatos que search() para que el orden de los
+ * prefijos sea determinista.
+ */
+static void enumerate(graceful_search_t *s, int depth, int target, int prev,
+                      graceful_mask_t used, graceful_mask_t free_diffs,
+                      graceful_prefix_cb cb, void *user) {
+    if (depth == target) {
+        graceful_prefix_t prefix;
+        make_prefix(s, depth, used, free_diffs, &prefix);
+        cb(&prefix, user);
+        return;
+    }
+
+    s->nodes++;
+    GRACEFUL_STAT_ADD(s, expanded, depth);
+
+    if (s->opt.symmetry && symmetry_dead(s, depth, prev, used, free_diffs)) {
+        GRACEFUL_STAT_ADD(s, cut, depth);
+        return;
+    }
+
+    // Igual que search(): en el penúltimo nivel no se aplica la anticipación
+    if (depth < s->n - 1 && s->opt.lookahead && lookahead_dead(s, prev, used, free_diffs)) {
+        s->lookahead_cuts++;
+        GRACEFUL_STAT_ADD(s, cut, depth);
+        return;
+    }
+
+    graceful_mask_t pending = free_diffs;
+    while (pending) {
+        int d = __builtin_ctzll(pending);
+        pending &= pending - 1;
+        graceful_mask_t rest = free_diffs & ~GRACEFUL_BIT(d);
+
+        if (d == s->n - 1) {
+            s->weight = s->edge_weight[depth];
+        }
+
+        int next = prev - d;
+        if (next >= 1 && !(used & GRACEFUL_BIT(next))) {
+            s->perm[depth] = next;
+            enumerate(s, depth + 1, target, next, used | GRACEFUL_BIT(next), rest, cb, user);
+        } else {
+            GRACEFUL_STAT_ADD(s, rejected, depth);
+        }
+
+        next = prev + d;
+        if (next <= s->n && !(used & GRACEFUL_BIT(next))) {
+            s->perm[depth] = next;
+            enumerate(s, depth + 1, target, next, used | GRACEFUL_BIT(next), rest, cb, user);
+        } else {
+            GRACEFUL_STAT_ADD(s, rejected, depth);
+        }
+    }
+}
+
+void graceful_enumerate_prefixes(graceful_search_t *s, int depth,
+                                 graceful_prefix_cb cb, void *user) {
+    if (depth < 1) depth = 1;
+    if (depth > s->n) depth = s->n;
+
+    s->nodes++; // raíz (prefijo vacío)
+    GRACEFUL_STAT_ADD(s, expanded, 0);
+
+    for (int first = 1; first <= s->n; first++) {
+        s->perm[0] = first;
+        enumerate(s, 1, depth, first, GRACEFUL_BIT(first), s->diffs, cb, user);
+    }
+}
+
+uint64_t graceful_count(graceful_search_t *s) {
+    s->count = 0;
+    s->nodes = 1; // raíz (prefijo vacío)
+    GRACEFUL_STAT_ADD(s, expanded, 0);
+
+    for (int first = 1; first <= s->n; first++) {
+        s->perm[0] = first;
+        search(s, 1, first, GRACEFUL_BIT(first), s->diffs);
+    }
+    return s->count;
+}
+
+void graceful_probe(graceful_search_t *s, int tail, uint64_t *rng, double *nodes, double *count) {
+    int n = s->n;
+    int next_list[2 * GRACEFUL_MAX_N];
+    int diff_list[2 * GRACEFUL_MAX_N];
+
+    // Raíz: n hijos. Cada nivel suma (producto de los grados hasta aquí) nodos estimados.
+    double width = n;
+    double est_nodes = 1.0 + width;
+    *rng ^= *rng << 13; *rng ^= *rng >> 7; *rng ^= *rng << 17;
+    int prev = 1 + (int)(*rng % (uint64_t)n);
+    graceful_mask_t used = GRACEFUL_BIT(prev);
+    graceful_mask_t free_diffs = s->diffs;
+    uint64_t weight = 1;
+
+    for (int depth = 1; ; depth++) {
+        if (n - depth <= tail) {
+            // Cola exacta: el subárbol se cuenta con search(), que incluye este nodo
+            uint64_t saved_count = s->count, saved_nodes = s->nodes;
+            s->count = 0;
+            s->nodes = 0;
+            s->weight = weight;
+            search(s, depth, prev, used, free_diffs);
+            *nodes = est_nodes + width * (double)(s->nodes - 1);
+            *count = width * (double)s->count;
+            s->count = saved_count;
+            s->nodes = saved_nodes;
+            return;
+        }
+        if (s->opt.symmetry && symmetry_dead(s, depth, prev, used, free_diffs)) {
+            break;
+        }
+        if (depth < n - 1 && s->opt.lookahead && lookahead_dead(s, prev, used, free_diffs)) {
+            break;
+        }
+
+        // Los mismos hijos que genera search(): prev±d para cada diferencia libre
+        int children = 0;
+        for (graceful_mask_t pending = free_diffs; pending; pending &= pending - 1) {
+            int d = __builtin_ctzll(pending);
+            if (prev - d >= 1 && !(used & GRACEFUL_BIT(prev - d))) {
+                next_list[children] = prev - d;
+                diff_list[children++] = d;
+            }
+            if (prev + d <= n && !(used & GRACEFUL_BIT(prev + d))) {
+                next_list[children] = prev + d;
+                diff_list[children++] = d;
+            }
+        }
+        if (children == 0) {
+            break;
+        }
+
+        *rng ^= *rng << 13; *rng ^= *rng >> 7; *rng ^= *rng << 17;
+        int pick = (int)(*rng % (uint64_t)children);
+        width *= children;
+        est_nodes += width;
+
+        if (diff_list[pick] == n - 1) {
+            weight = s->edge_weight[depth];
+        }
+        prev = next_list[pick];
+        used |= GRACEFUL_BIT(prev);
+        free_diffs &= ~GRACEFUL_BIT(diff_list[pick]);
+    }
+
+    *nodes = est_nodes;
+    *count = 0.0;
+}
+
+#ifdef GRACEFUL_STATS
+void graceful_stats_merge(graceful_stats_t *dst, const graceful_stats_t *src) {
+    for (int depth = 0; depth <= GRACEFUL_MAX_N; depth++) {
+        dst->expanded[depth] += src->expanded[depth];
+        dst->rejected[depth] += src->rejected[depth];
+        dst->cut[depth] += src->cut[depth];
+    }
+    dst->leaves += src->leaves;
+}
+
+void graceful_stats_print(const graceful_stats_t *stats, int n, FILE *out) {
+    fprintf(out, "%5s %16s %16s %16s\n", "nivel", "expandidos", "descartados", "podados");
+    for (int depth = 0; depth <= n; depth++) {
+        fprintf(out, "%5d %16llu %16llu %16llu\n", depth,
+                (unsigned long long)stats->expanded[depth],
+                (unsigned long long)stats->rejected[depth],
+                (unsigned long long)stats->cut[depth]);
+    }
+    fprintf(out, "hojas: %llu\n", (unsigned long long)stats->leaves);
+}
+#endif
+
+void graceful_set_memo(graceful_search_t *s, memo_table_t *memo, int levels) {
+    s->memo = memo;
+    if (!memo || levels < GRACEFUL_MEMO_MIN_LEFT) {
+        s->memo_from = s->n + 1;
+        s->memo_to = 0;
+        return;
+    }
+    s->memo_from = s->n - levels;
+    s->memo_to = s->n - GRACEFUL_MEMO_MIN_LEFT;
+}
+
+void graceful_set_leaf(graceful_search_t *s, graceful_leaf_cb cb, void *user) {
+    s->leaf_cb = cb;
+    s->leaf_user = user;
+}
+
+void graceful_set_checkpoint(graceful_search_t *s, volatile sig_atomic_t *flag,
+                             graceful_checkpoint_cb cb, void *user) {
+    s->checkpoint_flag = flag;
+    s->checkpoint_cb = cb;
+    s->checkpoint_user = user;
+}
+
+/**
+ * @brief Baja por el camino de un punto de control sin volver a contar sus ancestros.
+ *
+ * En cada nivel recorre los candidatos en el orden de search(): los anteriores
+ * al del camino ya se exploraron antes del punto de control, el del camino se
+ * sigue (con resume() o, en el último nivel, con search()) y los posteriores se
+ * exploran normalmente.
+ */
+static void resume(graceful_search_t *s, int depth, int prev, graceful_mask_t used,
+                   graceful_mask_t free_diffs, const graceful_prefix_t *at) {
+    int target = at->perm[depth];
+    bool found = false;
+
+    graceful_mask_t pending = free_diffs;
+    while (pending) {
+        int d = __builtin_ctzll(pending);
+        pending &= pending - 1;
+        graceful_mask_t rest = free_diffs & ~GRACEFUL_BIT(d);
+
+        if (d == s->n - 1) {
+            s->weight = s->edge_weight[depth];
+        }
+
+        int candidates[2] = { prev - d, prev + d };
+        for (int k = 0; k < 2; k++) {
+            int next = candidates[k];
+            if (next < 1 || next > s->n || (used & GRACEFUL_BIT(next))) {
+                continue;
+            }
+            if (!found && next != target) {
+                continue; // explorado antes del punto de control
+            }
+
+            s->perm[depth] = next;
+            if (!found && depth + 1 < at->depth) {
+                resume(s, depth + 1, next, used | GRACEFUL_BIT(next), rest, at);
+            } else {
+                search(s, depth + 1, next, used | GRACEFUL_BIT(next), rest);
+            }
+            found = true;
+        }
+    }
+}
+
+uint64_t graceful_resume(graceful_search_t *s, const graceful_prefix_t *at,
+                         uint64_t count, uint64_t nodes) {
+    s->count = count;
+    s->nodes = nodes;
+    s->weight = at->weight;
+
+    for (int first = at->perm[0]; first <= s->n; first++) {
+        s->perm[0] = first;
+        if (first == at->perm[0] && at->depth > 1) {
+            resume(s, 1, first, GRACEFUL_BIT(first), s->diffs, at);
+        } else {
+            search(s, 1, first, GRACEFUL_BIT(first), s->diffs);
+        }
+    }
+    return s->count;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file kernel.c
+ * @brief Núcleos especializados por n con pila explícita.
+ *
+ * Los candidatos de un nodo se calculan de una vez como máscara: prev+d son
+ * los bits de (libres << prev), y prev-d salen de una copia espejada de las
+ * diferencias libres (la diferencia d en el bit 63-d) desplazada a la derecha
+ * 63-prev lugares. Cada marco de la pila guarda la máscara de candidatos
+ * pendientes, así que avanzar al siguiente hijo es un ctz.
+ */
+
+#include "include/kernel.h"
+#include <stddef.h>
+
+#define MIRROR(d) ((uint64_t)1 << (63 - (d)))   ///< Bit de la diferencia d en la máscara espejada
+
+/**
+ * @struct frame_t
+ * @brief Un nivel de la pila explícita.
+ */
+typedef struct {
+    uint64_t cand;      /**< Candidatos aún no visitados. */
+    uint64_t used;      /**< Números usados. */
+    uint64_t free;      /**< Diferencias libres (bit d). */
+    uint64_t mirror;    /**< Diferencias libres espejadas (bit 63-d). */
+    int prev;           /**< Último elemento colocado. */
+} frame_t;
+
+/**
+ * @brief Búsqueda completa para un n constante.
+ *
+ * Siempre se expande en línea dentro de una función con n literal, así el
+ * compilador conoce las máscaras, los límites y el tamaño de la pila.
+ */
+static inline __attribute__((always_inline)) void kernel_body(const int n, uint64_t *count_out,
+                                                              uint64_t *nodes_out) {
+    const uint64_t numbers = (((uint64_t)1 << n) - 1) << 1;    // bits 1..n
+    uint64_t all_mirror = 0;
+    for (int d = 1; d < n; d++) {
+        all_mirror |= MIRROR(d);
+    }
+    const uint64_t all_free = (((uint64_t)1 << (n - 1)) - 1) << 1;
+
+    frame_t stack[GRACEFUL_KERNEL_MAX_N];
+    uint64_t count = 0;
+    uint64_t nodes = 1; // raíz (prefijo vacío)
+
+    for (int first = 1; first <= n; first++) {
+        nodes++;
+        uint64_t used = (uint64_t)1 << first;
+
+        if (n == 2) {
+            // Profundidad 1 = n-1: el último número queda determinado
+            nodes++;
+            count++;
+            continue;
+        }
+
+        stack[1].used = used;
+        stack[1].free = all_free;
+        stack[1].mirror = all_mirror;
+        stack[1].prev = first;
+        stack[1].cand = ((all_free << first) | (all_mirror >> (63 - first))) & numbers & ~used;
+
+        int depth = 1;
+        while (depth >= 1) {
+            frame_t *f = &stack[depth];
+            if (!f->cand) {
+                depth--;
+                continue;
+            }
+            int next = __builtin_ctzll(f->cand);
+            f->cand &= f->cand - 1;
+
+            int d = next > f->prev ? next - f->prev : f->prev - next;
+            uint64_t child_used = f->used | ((uint64_t)1 << next);
+            uint64_t child_free = f->free & ~((uint64_t)1 << d);
+            nodes++;
+
+            if (depth + 1 == n - 1) {
+                // Penúltimo nivel: queda un número y una diferencia
+                int last = __builtin_ctzll(numbers & ~child_used);
+                int diff = last > next ? last - next : next - last;
+                if (child_free == (uint64_t)1 << diff) {
+                    nodes++;
+                    count++;
+                }
+                continue;
+            }
+
+            frame_t *c = &stack[depth + 1];
+            c->used = child_used;
+            c->free = child_free;
+            c->mirror = f->mirror & ~MIRROR(d);
+            c->prev = next;
+            c->cand = ((child_free << next) | (c->mirror >> (63 - next))) & numbers & ~child_used;
+            depth++;
+        }
+    }
+
+    *count_out = count;
+    *nodes_out = nodes;
+}
+
+/// Genera el núcleo de un n fijo.
+#define DEFINE_KERNEL(N) \
+    static void kernel_##N(uint64_t *count, uint64_t *nodes) { kernel_body(N, count, nodes); }
+
+DEFINE_KERNEL(2)  DEFINE_KERNEL(3)  DEFINE_KERNEL(4)  DEFINE_KERNEL(5)
+DEFINE_KERNEL(6)  DEFINE_KERNEL(7)  DEFINE_KERNEL(8)  DEFINE_KERNEL(9)
+DEFINE_KERNEL(10) DEFINE_KERNEL(11) DEFINE_KERNEL(12) DEFINE_KERNEL(13)
+DEFINE_KERNEL(14) DEFINE_KERNEL(15) DEFINE_KERNEL(16) DEFINE_KERNEL(17)
+DEFINE_KERNEL(18) DEFINE_KERNEL(19) DEFINE_KERNEL(20) DEFINE_KERNEL(21)
+DEFINE_KERNEL(22) DEFINE_KERNEL(23) DEFINE_KERNEL(24)
+
+/// Tabla de despacho indexada por n.
+static void (*const kernels[GRACEFUL_KERNEL_MAX_N + 1])(uint64_t *, uint64_t *) = {
+    [2] = kernel_2,   [3] = kernel_3,   [4] = kernel_4,   [5] = kernel_5,
+    [6] = kernel_6,   [7] = kernel_7,   [8] = kernel_8,   [9] = kernel_9,
+    [10] = kernel_10, [11] = kernel_11, [12] = kernel_12, [13] = kernel_13,
+    [14] = kernel_14, [15] = kernel_15, [16] = kernel_16, [17] = kernel_17,
+    [18] = kernel_18, [19] = kernel_19, [20] = kernel_20, [21] = kernel_21,
+    [22] = kernel_22, [23] = kernel_23, [24] = kernel_24,
+};
+
+bool graceful_kernel_count(int n, uint64_t *count, uint64_t *nodes) {
+    if (n < GRACEFUL_KERNEL_MIN_N || n > GRACEFUL_KERNEL_MAX_N) {
+        return false;
+    }
+    kernels[n](count, nodes);
+    return true;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file memo.c
+ * @brief Reserva y estadísticas de la tabla de transposición.
+ */
+
+#include "include/memo.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool memo_init(memo_table_t *t, size_t bytes) {
+    memset(t, 0, sizeof(*t));
+
+    // Mayor potencia de dos de cubetas que entra en el presupuesto
+    size_t buckets = 1;
+    while (buckets * 2 * sizeof(memo_bucket_t) <= bytes) {
+        buckets *= 2;
+    }
+
+    t->buckets = calloc(buckets, sizeof(memo_bucket_t));
+    if (!t->buckets) {
+        return false;
+    }
+    t->mask = buckets - 1;
+    return true;
+}
+
+void memo_free(memo_table_t *t) {
+    free(t->buckets);
+    t->buckets = NULL;
+    t->mask = 0;
+}
+
+void memo_stats_merge(memo_table_t *dst, const memo_table_t *src) {
+    dst->probes += src->probes;
+    dst->hits += src->hits;
+    dst->stores += src->stores;
+    dst->evictions += src->evictions;
+}
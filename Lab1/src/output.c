@@ -0,0 +1,116 @@
+/**
+ * @file output.c
+ * @brief Implementación de la escritura binaria de permutaciones.
+ */
+
+#include "include/output.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Escribe todo el bloque, reintentando escrituras parciales.
+ * @return true si se escribió completo.
+ */
+static bool write_all(int fd, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t done = write(fd, data, len);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += done;
+        len -= (size_t)done;
+    }
+    return true;
+}
+
+bool perm_sink_open(perm_sink_t *sink, const char *path, int n, bool rank) {
+    if (rank && n > PERM_RANK_MAX_N) {
+        return false;
+    }
+    sink->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (sink->fd < 0) {
+        return false;
+    }
+    pthread_mutex_init(&sink->lock, NULL);
+    sink->n = n;
+    sink->rank = rank;
+    sink->failed = false;
+    sink->records = 0;
+    return true;
+}
+
+bool perm_sink_close(perm_sink_t *sink) {
+    bool ok = !sink->failed;
+    ok = close(sink->fd) == 0 && ok;
+    pthread_mutex_destroy(&sink->lock);
+    return ok;
+}
+
+bool perm_writer_init(perm_writer_t *w, perm_sink_t *sink, size_t bytes) {
+    w->sink = sink;
+    w->record = sink->rank ? sizeof(uint64_t) : (size_t)sink->n;
+    w->cap = bytes / w->record * w->record;
+    if (w->cap == 0) {
+        w->cap = w->record;
+    }
+    w->len = 0;
+    w->buf = malloc(w->cap);
+    return w->buf != NULL;
+}
+
+void perm_writer_flush(perm_writer_t *w) {
+    if (w->len == 0) {
+        return;
+    }
+    perm_sink_t *sink = w->sink;
+    pthread_mutex_lock(&sink->lock);
+    if (!write_all(sink->fd, w->buf, w->len)) {
+        sink->failed = true;
+    }
+    sink->records += w->len / w->record;
+    pthread_mutex_unlock(&sink->lock);
+    w->len = 0;
+}
+
+void perm_writer_free(perm_writer_t *w) {
+    if (w->buf) {
+        perm_writer_flush(w);
+    }
+    free(w->buf);
+    w->buf = NULL;
+}
+
+uint64_t perm_rank(const int *perm, int n) {
+    // Código de Lehmer: cuántos valores menores quedan sin usar en cada posición
+    uint64_t rank = 0;
+    uint64_t left = ((uint64_t)1 << (n + 1)) - 2; // valores 1..n
+    for (int i = 0; i < n; i++) {
+        uint64_t bit = (uint64_t)1 << perm[i];
+        rank = rank * (uint64_t)(n - i) + (uint64_t)__builtin_popcountll(left & (bit - 1));
+        left &= ~bit;
+    }
+    return rank;
+}
+
+void perm_writer_put(const int *perm, int n, void *user) {
+    perm_writer_t *w = user;
+    if (w->len + w->record > w->cap) {
+        perm_writer_flush(w);
+    }
+
+    uint8_t *out = w->buf + w->len;
+    if (w->sink->rank) {
+        uint64_t rank = perm_rank(perm, n);
+        for (int i = 0; i < 8; i++) {
+            out[i] = (uint8_t)(rank >> (8 * i));
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            out[i] = (uint8_t)perm[i];
+        }
+    }
+    w->len += w->record;
+}
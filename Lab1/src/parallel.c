@@ -0,0 +1,312 @@
+/**
+ * @file parallel.c
+ * @brief Implementación del conteo paralelo con colas de robo de trabajo.
+ *
+ * Las tareas (prefijos) se generan una sola vez antes de lanzar los hilos y se
+ * reparten de forma intercalada entre las colas. Cada hilo consume su cola por
+ * el final y, cuando se vacía, roba por el frente de las colas de los demás.
+ * Como las tareas son gruesas (un subárbol completo), cada cola se protege con
+ * un mutex: el costo del bloqueo es despreciable frente al de una tarea.
+ */
+
+#include "include/parallel.h"
+#include "include/graceful.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TASKS_PER_THREAD 32  ///< Tareas mínimas por hilo al elegir la profundidad automática
+#define TASKS_PER_SHARD 256  ///< Tareas mínimas por fragmento al elegir la profundidad automática
+#define TASKS_FOR_PROGRESS 1024 ///< Tareas mínimas con informe de progreso, para que el porcentaje avance parejo
+
+/**
+ * @struct task_deque_t
+ * @brief Cola doble de índices de tareas. El dueño saca por el final y los ladrones por el frente.
+ */
+typedef struct {
+    pthread_mutex_t lock;   /**< Protege top y bottom. */
+    size_t *items;          /**< Índices de tareas. */
+    size_t top;             /**< Primer elemento válido (lado de los ladrones). */
+    size_t bottom;          /**< Uno después del último elemento (lado del dueño). */
+} task_deque_t;
+
+struct pool;
+
+/**
+ * @struct worker_t
+ * @brief Estado privado de cada hilo.
+ */
+typedef struct {
+    int id;                     /**< Índice del hilo. */
+    struct pool *pool;          /**< Pool al que pertenece. */
+    graceful_search_t search;   /**< Estado de búsqueda propio del hilo. */
+    memo_table_t memo;          /**< Tabla de transposición propia del hilo. */
+    perm_writer_t writer;       /**< Búfer de salida propio del hilo. */
+    size_t stolen;              /**< Tareas robadas a otros hilos. */
+    uint32_t rng;               /**< Semilla para elegir víctima. */
+    pthread_t thread;           /**< Hilo del sistema. */
+} worker_t;
+
+/**
+ * @struct pool
+ * @brief Conjunto de tareas, colas e hilos de una ejecución.
+ */
+typedef struct pool {
+    graceful_prefix_t *tasks;   /**< Prefijos a explorar. */
+    size_t task_count;          /**< Prefijos generados. */
+    size_t task_capacity;       /**< Capacidad reservada de @ref tasks. */
+    bool oom;                   /**< Falló una reserva al generar tareas. */
+    task_deque_t *deques;       /**< Una cola por hilo. */
+    worker_t *workers;          /**< Un estado por hilo. */
+    int threads;                /**< Cantidad de hilos. */
+    int ready_deques;           /**< Colas ya inicializadas. */
+    size_t seen;                /**< Prefijos generados, incluidos los de otros fragmentos. */
+    int shard_index;            /**< Fragmento propio. */
+    int shard_count;            /**< Cantidad de fragmentos. */
+    progress_t *progress;       /**< Contadores de progreso (NULL: sin informe). */
+} pool_t;
+
+/**
+ * @brief Agrega un prefijo a la lista de tareas (callback de graceful_enumerate_prefixes()).
+ */
+static void collect_task(const graceful_prefix_t *prefix, void *user) {
+    pool_t *pool = user;
+    if (pool->oom) return;
+
+    // Reparto entre procesos: el fragmento i se queda con las tareas i, i+k, i+2k, ...
+    size_t index = pool->seen++;
+    if (index % (size_t)pool->shard_count != (size_t)pool->shard_index) return;
+
+    if (pool->task_count == pool->task_capacity) {
+        size_t capacity = pool->task_capacity ? pool->task_capacity * 2 : 1024;
+        graceful_prefix_t *tasks = realloc(pool->tasks, capacity * sizeof(*tasks));
+        if (!tasks) {
+            pool->oom = true;
+            return;
+        }
+        pool->tasks = tasks;
+        pool->task_capacity = capacity;
+    }
+    pool->tasks[pool->task_count++] = *prefix;
+}
+
+/**
+ * @brief Cuenta prefijos sin guardarlos (para elegir la profundidad automática).
+ */
+static void count_task(const graceful_prefix_t *prefix, void *user) {
+    (void)prefix;
+    (*(size_t *)user)++;
+}
+
+/**
+ * @brief Elige la menor profundidad que genera al menos @p min_tasks tareas.
+ */
+static int auto_split_depth(int n, size_t min_tasks, const graceful_options_t *opt) {
+    graceful_search_t scratch;
+    graceful_search_init(&scratch, n, opt);
+
+    for (int depth = 1; depth < n; depth++) {
+        size_t tasks = 0;
+        graceful_enumerate_prefixes(&scratch, depth, count_task, &tasks);
+        if (tasks >= min_tasks) {
+            return depth;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Saca una tarea del final de la cola propia.
+ * @return true si había una tarea.
+ */
+static bool deque_pop(task_deque_t *q, size_t *task) {
+    bool ok = false;
+    pthread_mutex_lock(&q->lock);
+    if (q->bottom > q->top) {
+        *task = q->items[--q->bottom];
+        ok = true;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+/**
+ * @brief Roba una tarea del frente de una cola ajena.
+ * @return true si había una tarea.
+ */
+static bool deque_steal(task_deque_t *q, size_t *task) {
+    bool ok = false;
+    pthread_mutex_lock(&q->lock);
+    if (q->bottom > q->top) {
+        *task = q->items[q->top++];
+        ok = true;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+/**
+ * @brief Intenta robar de las demás colas, empezando por una víctima pseudoaleatoria.
+ * @return true si consiguió una tarea.
+ */
+static bool steal_any(worker_t *w, size_t *task) {
+    pool_t *pool = w->pool;
+
+    w->rng = w->rng * 1103515245u + 12345u;
+    int start = (int)((w->rng >> 16) % (uint32_t)pool->threads);
+
+    for (int i = 0; i < pool->threads; i++) {
+        int victim = (start + i) % pool->threads;
+        if (victim != w->id && deque_steal(&pool->deques[victim], task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Cuerpo de cada hilo: vacía su cola y luego roba hasta que no quede trabajo.
+ *
+ * No se agregan tareas durante la ejecución, así que cuando todas las colas
+ * están vacías el hilo puede terminar.
+ */
+static void *worker_main(void *arg) {
+    worker_t *w = arg;
+    pool_t *pool = w->pool;
+    size_t task;
+
+    for (;;) {
+        if (!deque_pop(&pool->deques[w->id], &task)) {
+            if (!steal_any(w, &task)) {
+                break;
+            }
+            w->stolen++;
+        }
+        uint64_t nodes_before = w->search.nodes;
+        graceful_search_prefix(&w->search, &pool->tasks[task]);
+        progress_task_done(pool->progress, w->search.nodes - nodes_before);
+    }
+    return NULL;
+}
+
+bool graceful_count_parallel(int n, const graceful_parallel_config_t *cfg,
+                             graceful_parallel_result_t *out) {
+    pool_t pool = {0};
+    bool ok = false;
+
+    pool.threads = cfg->threads;
+    if (pool.threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        pool.threads = cores > 0 ? (int)cores : 1;
+    }
+
+    pool.shard_count = cfg->shard_count > 1 ? cfg->shard_count : 1;
+    pool.shard_index = pool.shard_count > 1 ? cfg->shard_index : 0;
+    if (pool.shard_index < 0 || pool.shard_index >= pool.shard_count) goto cleanup;
+
+    // Con fragmentos la profundidad automática no depende de los hilos ni del
+    // informe de progreso, para que todos los procesos corten el árbol igual
+    size_t min_tasks = pool.shard_count > 1 ? (size_t)pool.shard_count * TASKS_PER_SHARD
+                                            : (size_t)pool.threads * TASKS_PER_THREAD;
+    if (cfg->progress && pool.shard_count == 1 && min_tasks < TASKS_FOR_PROGRESS) {
+        min_tasks = TASKS_FOR_PROGRESS;
+    }
+    int depth = cfg->split_depth > 0 ? cfg->split_depth : auto_split_depth(n, min_tasks, &cfg->search);
+    if (depth > n) depth = n;
+
+    // Generación de tareas: los nodos por encima del corte se cuentan aquí
+    graceful_search_t head;
+    graceful_search_init(&head, n, &cfg->search);
+    graceful_enumerate_prefixes(&head, depth, collect_task, &pool);
+    if (pool.oom) goto cleanup;
+    pool.progress = cfg->progress;
+    progress_set_total(pool.progress, pool.task_count, pool.shard_index == 0 ? head.nodes : 0);
+
+    pool.deques = calloc((size_t)pool.threads, sizeof(*pool.deques));
+    pool.workers = calloc((size_t)pool.threads, sizeof(*pool.workers));
+    if (!pool.deques || !pool.workers) goto cleanup;
+
+    for (; pool.ready_deques < pool.threads; pool.ready_deques++) {
+        task_deque_t *q = &pool.deques[pool.ready_deques];
+        q->items = malloc((pool.task_count / (size_t)pool.threads + 1) * sizeof(*q->items));
+        if (!q->items) goto cleanup;
+        pthread_mutex_init(&q->lock, NULL);
+    }
+
+    // Reparto intercalado: tareas vecinas (de tamaño parecido) van a hilos distintos
+    for (size_t t = 0; t < pool.task_count; t++) {
+        task_deque_t *q = &pool.deques[t % (size_t)pool.threads];
+        q->items[q->bottom++] = t;
+    }
+
+    int started = 0;
+    for (; started < pool.threads; started++) {
+        worker_t *w = &pool.workers[started];
+        w->id = started;
+        w->pool = &pool;
+        w->rng = (uint32_t)started * 2654435761u + 1u;
+        graceful_search_init(&w->search, n, &cfg->search);
+        if (cfg->memo_bytes) {
+            if (!memo_init(&w->memo, cfg->memo_bytes / (size_t)pool.threads)) break;
+            graceful_set_memo(&w->search, &w->memo, cfg->memo_levels);
+        }
+        if (cfg->output) {
+            if (!perm_writer_init(&w->writer, cfg->output, PERM_WRITER_BUFFER)) break;
+            graceful_set_leaf(&w->search, perm_writer_put, &w->writer);
+        }
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) break;
+    }
+
+    // Si algún hilo no arrancó, los que sí lo hicieron le roban sus tareas
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+    if (started == 0) goto cleanup;
+
+    // Los nodos por encima del corte los recorren todos los fragmentos, pero solo el 0 los suma
+    if (pool.shard_index != 0) {
+        head.nodes = 0;
+        head.lookahead_cuts = 0;
+#ifdef GRACEFUL_STATS
+        memset(&head.stats, 0, sizeof(head.stats));
+#endif
+    }
+    out->count = head.count;
+    out->nodes = head.nodes;
+    out->lookahead_cuts = head.lookahead_cuts;
+    out->steals = 0;
+    out->memo = (memo_table_t){0};
+#ifdef GRACEFUL_STATS
+    out->stats = head.stats;
+#endif
+    for (int i = 0; i < started; i++) {
+        out->count += pool.workers[i].search.count;
+        out->nodes += pool.workers[i].search.nodes;
+        out->lookahead_cuts += pool.workers[i].search.lookahead_cuts;
+        out->steals += pool.workers[i].stolen;
+        memo_stats_merge(&out->memo, &pool.workers[i].memo);
+#ifdef GRACEFUL_STATS
+        graceful_stats_merge(&out->stats, &pool.workers[i].search.stats);
+#endif
+    }
+    out->tasks = pool.task_count;
+    out->total_tasks = pool.seen;
+    out->threads = started;
+    out->split_depth = depth;
+    ok = true;
+
+cleanup:
+    for (int i = 0; i < pool.ready_deques; i++) {
+        free(pool.deques[i].items);
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    free(pool.deques);
+    for (int i = 0; pool.workers && i < pool.threads; i++) {
+        memo_free(&pool.workers[i].memo);
+        perm_writer_free(&pool.workers[i].writer);
+    }
+    free(pool.workers);
+    free(pool.tasks);
+    return ok;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file progress.c
+ * @brief Implementación del hilo que informa el progreso.
+ */
+
+#include "include/progress.h"
+#include "include/timing.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief Escribe una duración en segundos como h:mm:ss.
+ */
+static void format_duration(double seconds, char *buf, size_t size) {
+    uint64_t s = seconds > 0.0 ? (uint64_t)(seconds + 0.5) : 0;
+    snprintf(buf, size, "%" PRIu64 ":%02u:%02u", s / 3600, (unsigned)(s / 60 % 60), (unsigned)(s % 60));
+}
+
+/**
+ * @brief Lee los contadores y escribe un informe.
+ * @param final true si la búsqueda terminó.
+ */
+static void report(const progress_t *p, bool final) {
+    uint64_t done = atomic_load_explicit(&p->tasks_done, memory_order_relaxed);
+    uint64_t total = atomic_load_explicit(&p->tasks_total, memory_order_relaxed);
+    uint64_t nodes = atomic_load_explicit(&p->nodes, memory_order_relaxed);
+    double elapsed = (double)(timing_now_ns() - p->start_ns) / 1e9;
+
+    double percent = total ? 100.0 * (double)done / (double)total : 0.0;
+    double rate = elapsed > 0.0 ? (double)nodes / elapsed : 0.0;
+    // Sin tareas terminadas no hay con qué extrapolar
+    double remaining = done && total ? elapsed * (double)(total - done) / (double)done : -1.0;
+
+    char elapsed_text[32], remaining_text[32];
+    format_duration(elapsed, elapsed_text, sizeof(elapsed_text));
+    if (remaining >= 0.0) {
+        format_duration(remaining, remaining_text, sizeof(remaining_text));
+    } else {
+        snprintf(remaining_text, sizeof(remaining_text), "?");
+    }
+
+    if (!p->status_path) {
+        fprintf(stderr, "[progreso n=%d] %5.1f%% (%" PRIu64 "/%" PRIu64 " tareas) %.3g nodos/s, "
+                "transcurrido %s, restante %s%s\n", p->n, percent, done, total, rate, elapsed_text,
+                remaining_text, final ? " (fin)" : "");
+        return;
+    }
+
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", p->status_path) >= (int)sizeof(tmp)) {
+        return;
+    }
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        return;
+    }
+    fprintf(f, "n=%d\nestado=%s\n", p->n, final ? "terminado" : "en curso");
+    fprintf(f, "tareas=%" PRIu64 "\ntareas_totales=%" PRIu64 "\nporcentaje=%.2f\n", done, total, percent);
+    fprintf(f, "nodos=%" PRIu64 "\nnodos_por_s=%.0f\n", nodes, rate);
+    fprintf(f, "transcurrido_s=%.0f\nrestante_s=%.0f\n", elapsed, remaining);
+    bool ok = !ferror(f);
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp, p->status_path) != 0) {
+        remove(tmp);
+    }
+}
+
+/**
+ * @brief Cuerpo del hilo que informa: duerme un intervalo (o hasta la parada) y escribe.
+ */
+static void *progress_main(void *arg) {
+    progress_t *p = arg;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += p->interval_s;
+        while (!p->stop && pthread_cond_timedwait(&p->wake, &p->lock, &deadline) == 0) {
+        }
+        if (!p->stop) {
+            pthread_mutex_unlock(&p->lock);
+            report(p, false);
+            pthread_mutex_lock(&p->lock);
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+bool progress_start(progress_t *p, int n, int interval_s, const char *status_path) {
+    atomic_init(&p->tasks_done, 0);
+    atomic_init(&p->tasks_total, 0);
+    atomic_init(&p->nodes, 0);
+    p->n = n;
+    p->interval_s = interval_s > 0 ? interval_s : 1;
+    p->status_path = status_path;
+    p->start_ns = timing_now_ns();
+    p->stop = false;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+
+    p->running = pthread_create(&p->thread, NULL, progress_main, p) == 0;
+    if (!p->running) {
+        pthread_cond_destroy(&p->wake);
+        pthread_mutex_destroy(&p->lock);
+    }
+    return p->running;
+}
+
+void progress_set_total(progress_t *p, uint64_t tasks, uint64_t head_nodes) {
+    if (p) {
+        atomic_fetch_add_explicit(&p->nodes, head_nodes, memory_order_relaxed);
+        atomic_store_explicit(&p->tasks_total, tasks, memory_order_relaxed);
+    }
+}
+
+void progress_stop(progress_t *p) {
+    if (!p->running) {
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->stop = true;
+    pthread_cond_signal(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    pthread_join(p->thread, NULL);
+    p->running = false;
+
+    report(p, true);
+    pthread_cond_destroy(&p->wake);
+    pthread_mutex_destroy(&p->lock);
+}
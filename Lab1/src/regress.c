@@ -0,0 +1,167 @@
+/**
+ * @file regress.c
+ * @brief Implementación de la compuerta de regresión.
+ */
+
+#include "include/regress.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BASE_MAX_COLUMNS 16    ///< Columnas leídas del CSV base
+
+/// Permutaciones gráciles de 1..n publicadas, n = 1..REGRESS_KNOWN_MAX_N.
+static const uint64_t known_counts[REGRESS_KNOWN_MAX_N + 1] = {
+    0, 1, 2, 4, 4, 8, 24, 32, 40, 120, 296, 648, 1328, 3200, 9912, 25592, 55920
+};
+
+/**
+ * @struct base_row_t
+ * @brief Fila del archivo base.
+ */
+typedef struct {
+    bool present;       /**< El n está en la base. */
+    uint64_t nodes;     /**< Nodos visitados. */
+    double wall_ms;     /**< Mediana del tiempo de pared. */
+    double nodes_per_s; /**< Nodos por segundo. */
+} base_row_t;
+
+uint64_t regress_known_count(int n) {
+    return n >= 1 && n <= REGRESS_KNOWN_MAX_N ? known_counts[n] : 0;
+}
+
+/**
+ * @brief Lee las columnas engine, n, nodes, wall_ms y nodes_per_s del CSV base.
+ * @return false si el archivo no existe o no tiene esas columnas.
+ */
+static bool load_base(const char *path, base_row_t *rows, char *engine, size_t engine_len) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    char line[512];
+    int col_engine = -1, col_n = -1, col_nodes = -1, col_wall = -1, col_rate = -1;
+    if (fgets(line, sizeof(line), f)) {
+        int col = 0;
+        for (char *tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n"), col++) {
+            if (strcmp(tok, "engine") == 0) col_engine = col;
+            else if (strcmp(tok, "n") == 0) col_n = col;
+            else if (strcmp(tok, "nodes") == 0) col_nodes = col;
+            else if (strcmp(tok, "wall_ms") == 0) col_wall = col;
+            else if (strcmp(tok, "nodes_per_s") == 0) col_rate = col;
+        }
+    }
+    if (col_n < 0 || col_nodes < 0 || col_wall < 0 || col_rate < 0) {
+        fclose(f);
+        return false;
+    }
+
+    engine[0] = '\0';
+    while (fgets(line, sizeof(line), f)) {
+        char *field[BASE_MAX_COLUMNS] = {0};
+        int cols = 0;
+        for (char *tok = strtok(line, ",\r\n"); tok && cols < BASE_MAX_COLUMNS; tok = strtok(NULL, ",\r\n")) {
+            field[cols++] = tok;
+        }
+        if (col_n >= cols || col_nodes >= cols || col_wall >= cols || col_rate >= cols) continue;
+
+        int n = atoi(field[col_n]);
+        if (n < 1 || n > REGRESS_KNOWN_MAX_N) continue;
+        rows[n].present = true;
+        rows[n].nodes = strtoull(field[col_nodes], NULL, 10);
+        rows[n].wall_ms = atof(field[col_wall]);
+        rows[n].nodes_per_s = atof(field[col_rate]);
+        if (col_engine >= 0 && col_engine < cols) {
+            snprintf(engine, engine_len, "%s", field[col_engine]);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+int regress_run(const batch_config_t *batch, const regress_config_t *cfg, batch_run_fn run, void *user,
+                FILE *out) {
+    base_row_t base[REGRESS_KNOWN_MAX_N + 1] = {{0}};
+    batch_row_t rows[REGRESS_KNOWN_MAX_N + 1];
+    char base_engine[64];
+    bool have_base = false;
+    int to = cfg->to < REGRESS_KNOWN_MAX_N ? cfg->to : REGRESS_KNOWN_MAX_N;
+    int failures = 0;
+
+    if (cfg->baseline_path) {
+        have_base = load_base(cfg->baseline_path, base, base_engine, sizeof(base_engine));
+        if (!have_base && !cfg->update) {
+            fprintf(stderr, "No se pudo leer la base %s\n", cfg->baseline_path);
+            return -1;
+        }
+        if (have_base && base_engine[0] && strcmp(base_engine, batch->label) != 0) {
+            fprintf(out, "Aviso: la base se midió con %s y esta ejecución usa %s\n", base_engine, batch->label);
+        }
+    }
+
+    fprintf(out, "%3s %8s %8s %12s %14s %14s %8s  %s\n", "n", "conteo", "esperado", "tiempo_ms",
+            "nodos/s", "base nodos/s", "cambio", "estado");
+
+    for (int n = 1; n <= to; n++) {
+        batch_row_t *row = &rows[n];
+        if (!batch_measure(batch, n, run, user, row)) {
+            return -1;
+        }
+
+        uint64_t expected = known_counts[n];
+        const char *status = "OK";
+        double change = 0.0;
+        bool compared = false;
+
+        if (row->sample.count != expected) {
+            status = "CONTEO INCORRECTO";
+            failures++;
+        } else if (have_base && base[n].present && base[n].wall_ms >= cfg->min_ms) {
+            // Con el mismo árbol se compara la velocidad por nodo; si cambió, el tiempo total
+            double ratio = base[n].nodes == row->sample.nodes
+                         ? row->nodes_per_s / base[n].nodes_per_s
+                         : base[n].wall_ms / row->wall_ms;
+            change = ratio - 1.0;
+            compared = true;
+            if (ratio < 1.0 - cfg->tolerance) {
+                status = "MÁS LENTO";
+                failures++;
+            } else if (base[n].nodes != row->sample.nodes) {
+                status = "OK (árbol distinto: se compara el tiempo)";
+            }
+        } else if (have_base) {
+            status = base[n].present ? "OK (muy corto para comparar)" : "OK (sin base)";
+        }
+
+        fprintf(out, "%3d %8" PRIu64 " %8" PRIu64 " %12.3f %14.0f ", n, row->sample.count, expected,
+                row->wall_ms, row->nodes_per_s);
+        if (compared) {
+            fprintf(out, "%14.0f %+7.1f%%  %s\n", base[n].nodes_per_s, 100.0 * change, status);
+        } else {
+            fprintf(out, "%14s %8s  %s\n", "-", "-", status);
+        }
+        fflush(out);
+    }
+
+    fprintf(out, "%s: %d falla(s) con tolerancia %.0f%%\n", failures ? "FALLA" : "APROBADO", failures,
+            100.0 * cfg->tolerance);
+
+    // La base solo se actualiza con conteos correctos, para no fijar un resultado erróneo
+    if (cfg->update && cfg->baseline_path && failures == 0) {
+        FILE *f = fopen(cfg->baseline_path, "w");
+        if (!f) {
+            fprintf(stderr, "No se pudo escribir la base %s\n", cfg->baseline_path);
+            return -1;
+        }
+        batch_config_t csv = *batch;
+        csv.format = BATCH_CSV;
+        batch_write_header(&csv, f);
+        for (int n = 1; n <= to; n++) {
+            batch_write_row(&csv, &rows[n], n == 1, f);
+        }
+        fclose(f);
+        fprintf(out, "Base actualizada en %s\n", cfg->baseline_path);
+    }
+    return failures;
+}
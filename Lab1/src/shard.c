@@ -0,0 +1,133 @@
+/**
+ * @file shard.c
+ * @brief Implementación de los archivos de resultado de los fragmentos.
+ */
+
+#include "include/shard.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARD_MAGIC "graceful-shard 1"  ///< Primera línea del archivo
+#define SHARD_FIELDS 11                 ///< Campos obligatorios
+
+bool shard_save(const char *path, const shard_result_t *r) {
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return false;
+    }
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, SHARD_MAGIC "\n");
+    fprintf(f, "n=%d\nsimetria=%d\npoda=%d\npoda_min=%d\ncorte=%d\n", r->n, r->symmetry,
+            r->lookahead, r->lookahead_min_diff, r->split_depth);
+    fprintf(f, "fragmento=%d\nfragmentos=%d\n", r->index, r->shards);
+    fprintf(f, "tareas=%" PRIu64 "\ntareas_totales=%" PRIu64 "\n", r->tasks, r->total_tasks);
+    fprintf(f, "conteo=%" PRIu64 "\nnodos=%" PRIu64 "\n", r->count, r->nodes);
+    bool ok = !ferror(f);
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+bool shard_load(const char *path, shard_result_t *r) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    char line[256];
+    int fields = 0;
+    memset(r, 0, sizeof(*r));
+
+    if (!fgets(line, sizeof(line), f) || strncmp(line, SHARD_MAGIC, strlen(SHARD_MAGIC)) != 0) {
+        fclose(f);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char *eq = strchr(line, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        uint64_t v = strtoull(eq + 1, NULL, 10);
+
+        if (strcmp(line, "n") == 0) r->n = (int)v;
+        else if (strcmp(line, "simetria") == 0) r->symmetry = v != 0;
+        else if (strcmp(line, "poda") == 0) r->lookahead = v != 0;
+        else if (strcmp(line, "poda_min") == 0) r->lookahead_min_diff = (int)v;
+        else if (strcmp(line, "corte") == 0) r->split_depth = (int)v;
+        else if (strcmp(line, "fragmento") == 0) r->index = (int)v;
+        else if (strcmp(line, "fragmentos") == 0) r->shards = (int)v;
+        else if (strcmp(line, "tareas") == 0) r->tasks = v;
+        else if (strcmp(line, "tareas_totales") == 0) r->total_tasks = v;
+        else if (strcmp(line, "conteo") == 0) r->count = v;
+        else if (strcmp(line, "nodos") == 0) r->nodes = v;
+        else continue;
+        fields++;
+    }
+    fclose(f);
+    return fields == SHARD_FIELDS;
+}
+
+bool shard_merge(const char *const *paths, int count, shard_result_t *total, FILE *err) {
+    bool *seen = NULL;
+    bool ok = false;
+
+    for (int i = 0; i < count; i++) {
+        shard_result_t r;
+        if (!shard_load(paths[i], &r)) {
+            fprintf(err, "%s: no es un resultado de fragmento válido\n", paths[i]);
+            goto done;
+        }
+
+        if (i == 0) {
+            *total = r;
+            total->index = 0;
+            total->tasks = 0;
+            total->count = 0;
+            total->nodes = 0;
+            if (r.shards < 1 || r.shards != count) {
+                fprintf(err, "Se esperaban %d fragmentos y se recibieron %d\n", r.shards, count);
+                goto done;
+            }
+            seen = calloc((size_t)r.shards, sizeof(*seen));
+            if (!seen) goto done;
+        } else if (r.n != total->n || r.symmetry != total->symmetry || r.lookahead != total->lookahead
+                   || r.lookahead_min_diff != total->lookahead_min_diff
+                   || r.split_depth != total->split_depth || r.shards != total->shards
+                   || r.total_tasks != total->total_tasks) {
+            fprintf(err, "%s: corresponde a otra búsqueda (n, opciones, corte o fragmentos)\n", paths[i]);
+            goto done;
+        }
+
+        if (r.index < 0 || r.index >= total->shards || seen[r.index]) {
+            fprintf(err, "%s: fragmento %d repetido o fuera de rango\n", paths[i], r.index);
+            goto done;
+        }
+        seen[r.index] = true;
+        total->tasks += r.tasks;
+        total->count += r.count;
+        total->nodes += r.nodes;
+    }
+
+    if (count == 0) {
+        fprintf(err, "No hay fragmentos para combinar\n");
+        goto done;
+    }
+    if (total->tasks != total->total_tasks) {
+        fprintf(err, "Las tareas de los fragmentos suman %" PRIu64 " y deberían ser %" PRIu64 "\n",
+                total->tasks, total->total_tasks);
+        goto done;
+    }
+    ok = true;
+
+done:
+    free(seen);
+    return ok;
+}
@@ -0,0 +1,600 @@
+/**
+ * @file tree.c
+ * @brief Implementación del etiquetador grácil de árboles.
+ */
+
+#include "include/tree.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BIT(i) ((uint64_t)1 << (i))  ///< Máscara con únicamente el bit @p i encendido
+#define FIND_FIRST_BUDGET 100000u    ///< Nodos de los dos primeros intentos de --buscar (se duplica cada dos)
+
+/**
+ * @struct labeler_t
+ * @brief Estado de la búsqueda. Los arreglos se indexan por posición en el orden.
+ */
+typedef struct {
+    int vertices;                   /**< Vértices del árbol. */
+    int m;                          /**< Aristas (etiqueta máxima). */
+    int order[TREE_MAX_VERTICES];   /**< Vértice de cada posición. */
+    int parent[TREE_MAX_VERTICES];  /**< Posición del padre (-1 en la raíz). */
+    int first_leaf;                 /**< Posición de la primera hoja de la fase de hojas (vertices: sin fase). */
+    int sibling[TREE_MAX_VERTICES]; /**< Hoja hermana anterior en el orden de búsqueda (-1: ninguna). */
+    int diff[TREE_MAX_VERTICES];    /**< Diferencia con el padre de cada posición etiquetada. */
+    int leaf_start[TREE_MAX_VERTICES]; /**< Posición de la primera hoja de cada padre. */
+    int label[TREE_MAX_VERTICES];   /**< Etiqueta asignada. */
+    int pending[TREE_MAX_VERTICES]; /**< Vecinos aún sin etiquetar. */
+    int owner[TREE_MAX_VERTICES];   /**< Posición del vértice interno con cada etiqueta. */
+    int leaf_parent[TREE_MAX_VERTICES]; /**< Posición del padre de cada etiqueta de hoja. */
+    uint64_t leaf_labels;           /**< Etiquetas asignadas a hojas. */
+    uint64_t labels;                /**< Máscara con las etiquetas 0..m. */
+    uint64_t used;                  /**< Etiquetas usadas. */
+    uint64_t frontier;              /**< Etiquetas de vértices con vecinos pendientes. */
+    uint64_t free_diffs;            /**< Diferencias aún no usadas. */
+    uint64_t lookahead_mask;        /**< Diferencias verificadas por la poda. */
+    bool lookahead;                 /**< Poda por anticipación activa. */
+    bool find;                      /**< Detenerse en el primer etiquetado. */
+    bool stop;                      /**< Ya se encontró el etiquetado buscado o se agotó el presupuesto. */
+    bool randomize;                 /**< Orden de candidatos aleatorio (reinicios de --buscar). */
+    uint64_t rng;                   /**< Estado del generador xorshift64. */
+    uint64_t node_limit;            /**< Nodos totales a partir de los cuales se abandona el intento. */
+    bool out_of_budget;             /**< El intento se abandonó por presupuesto. */
+    uint64_t weight;                /**< Peso de la raíz actual por complemento. */
+    tree_result_t *out;             /**< Resultado. */
+} labeler_t;
+
+/**
+ * @brief Busca o agrega un identificador y devuelve su índice compacto.
+ * @return Índice, o -1 si ya hay TREE_MAX_VERTICES vértices.
+ */
+static int vertex_index(tree_t *t, long id) {
+    for (int i = 0; i < t->vertices; i++) {
+        if (t->ids[i] == id) return i;
+    }
+    if (t->vertices == TREE_MAX_VERTICES) return -1;
+    t->ids[t->vertices] = id;
+    return t->vertices++;
+}
+
+bool tree_load(const char *path, tree_t *t, FILE *err) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(err, "No se pudo abrir %s\n", path);
+        return false;
+    }
+    memset(t, 0, sizeof(*t));
+
+    char line[256];
+    int line_no = 0, edges = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') continue;
+
+        char *end;
+        long a = strtol(p, &end, 10);
+        if (end == p || a < 0) { ok = false; break; }
+        p = end;
+        long b = strtol(p, &end, 10);
+        if (end == p || b < 0) { ok = false; break; }
+        for (p = end; isspace((unsigned char)*p); p++) {}
+        if (*p != '\0') { ok = false; break; }
+
+        int u = vertex_index(t, a), v = vertex_index(t, b);
+        if (u < 0 || v < 0) {
+            fprintf(err, "%s:%d: más de %d vértices\n", path, line_no, TREE_MAX_VERTICES);
+            fclose(f);
+            return false;
+        }
+        if (u == v || (t->adjacent[u] & BIT(v))) {
+            fprintf(err, "%s:%d: lazo o arista repetida (%ld, %ld)\n", path, line_no, a, b);
+            fclose(f);
+            return false;
+        }
+        t->adjacent[u] |= BIT(v);
+        t->adjacent[v] |= BIT(u);
+        t->degree[u]++;
+        t->degree[v]++;
+        edges++;
+    }
+    fclose(f);
+    if (!ok) {
+        fprintf(err, "%s:%d: se esperaba una arista \"u v\"\n", path, line_no);
+        return false;
+    }
+
+    // Un grafo sin aristas se toma como un único vértice aislado
+    if (t->vertices == 0) {
+        t->vertices = 1;
+        return true;
+    }
+    if (edges != t->vertices - 1) {
+        fprintf(err, "%s: %d vértices y %d aristas no forman un árbol\n", path, t->vertices, edges);
+        return false;
+    }
+    uint64_t reached = BIT(0), frontier = BIT(0);
+    while (frontier) {
+        int v = __builtin_ctzll(frontier);
+        frontier &= frontier - 1;
+        uint64_t fresh = t->adjacent[v] & ~reached;
+        reached |= fresh;
+        frontier |= fresh;
+    }
+    if (reached != (t->vertices == 64 ? ~(uint64_t)0 : BIT(t->vertices) - 1)) {
+        fprintf(err, "%s: el grafo no es conexo\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Arma el orden de conteo y la multiplicidad de las hojas hermanas.
+ *
+ * La raíz es el vértice de mayor grado. Después se agregan los vértices
+ * internos vecinos de los ya ordenados, siempre el de mayor grado primero, y
+ * al final las hojas de cada padre juntas, en el orden de sus padres, para la
+ * fase de hojas.
+ */
+static void build_order(const tree_t *t, labeler_t *L) {
+    int pos_of[TREE_MAX_VERTICES];
+    uint64_t placed = 0;
+    int count = 0;
+
+    int root = 0;
+    for (int v = 1; v < t->vertices; v++) {
+        if (t->degree[v] > t->degree[root]) root = v;
+    }
+    L->order[0] = root;
+    L->parent[0] = -1;
+    L->sibling[0] = -1;
+    pos_of[root] = count++;
+    placed |= BIT(root);
+
+    for (;;) {
+        int best = -1;
+        for (int v = 0; v < t->vertices; v++) {
+            if ((placed & BIT(v)) || t->degree[v] < 2 || !(t->adjacent[v] & placed)) continue;
+            if (best < 0 || t->degree[v] > t->degree[best]) best = v;
+        }
+        if (best < 0) break;
+        L->order[count] = best;
+        L->parent[count] = pos_of[__builtin_ctzll(t->adjacent[best] & placed)];
+        L->sibling[count] = -1;
+        pos_of[best] = count++;
+        placed |= BIT(best);
+    }
+
+    uint64_t multiplier = 1;
+    L->first_leaf = count;
+    for (int p = 0; p < L->first_leaf; p++) {
+        uint64_t leaves = t->adjacent[L->order[p]] & ~placed;
+        int siblings = 0;
+        L->leaf_start[p] = count;
+        for (; leaves; leaves &= leaves - 1) {
+            int v = __builtin_ctzll(leaves);
+            L->order[count] = v;
+            L->parent[count] = p;
+            pos_of[v] = count++;
+            placed |= BIT(v);
+            siblings++;
+            if (__builtin_mul_overflow(multiplier, (uint64_t)siblings, &multiplier)) {
+                L->out->overflow = true;
+            }
+        }
+    }
+    L->out->multiplier = multiplier;
+}
+
+/**
+ * @brief Agrega v y su subárbol al orden de búsqueda: primero sus hojas y
+ *        después cada hijo interno con su subárbol, de mayor a menor grado.
+ */
+static void place_subtree(const tree_t *t, labeler_t *L, int v, int parent, uint64_t *placed, int *count) {
+    int pos = (*count)++;
+    L->order[pos] = v;
+    L->parent[pos] = parent;
+    L->sibling[pos] = -1;
+    *placed |= BIT(v);
+
+    uint64_t children = t->adjacent[v] & ~*placed;
+    int previous = -1;
+    for (uint64_t c = children; c; c &= c - 1) {
+        int leaf = __builtin_ctzll(c);
+        if (t->degree[leaf] != 1) continue;
+        L->order[*count] = leaf;
+        L->parent[*count] = pos;
+        L->sibling[*count] = previous;
+        previous = (*count)++;
+        *placed |= BIT(leaf);
+    }
+    for (;;) {
+        int best = -1;
+        for (uint64_t c = children & ~*placed; c; c &= c - 1) {
+            int u = __builtin_ctzll(c);
+            if (best < 0 || t->degree[u] > t->degree[best]) best = u;
+        }
+        if (best < 0) break;
+        place_subtree(t, L, best, pos, placed, count);
+    }
+}
+
+/**
+ * @brief Arma el orden de búsqueda de un etiquetado.
+ *
+ * Recorrido en profundidad desde un vértice interno en un extremo del
+ * subárbol de internos, con las hojas de cada vértice antes que sus hijos
+ * internos. Con las diferencias de mayor a menor, el primer descenso en una
+ * oruga es la construcción clásica: 0 en un extremo de la columna, sus hojas
+ * con m, m-1, ..., el siguiente vértice de la columna con la etiqueta alta que
+ * sigue, sus hojas con 1, 2, ..., y así alternando.
+ */
+static void build_find_order(const tree_t *t, labeler_t *L) {
+    uint64_t internal = 0;
+    for (int v = 0; v < t->vertices; v++) {
+        if (t->degree[v] >= 2) internal |= BIT(v);
+    }
+    int root = 0, root_inner = TREE_MAX_VERTICES;
+    for (int v = 0; v < t->vertices; v++) {
+        if (internal && !(internal & BIT(v))) continue;
+        int inner = __builtin_popcountll(t->adjacent[v] & internal);
+        if (inner < root_inner || (inner == root_inner && t->degree[v] > t->degree[root])) {
+            root = v;
+            root_inner = inner;
+        }
+    }
+
+    uint64_t placed = 0;
+    int count = 0;
+    place_subtree(t, L, root, -1, &placed, &count);
+    L->first_leaf = t->vertices;  // sin fase de hojas: las hojas ya están en el orden
+    L->out->multiplier = 1;
+}
+
+/**
+ * @brief Indica si alguna diferencia grande libre ya no puede realizarse.
+ *
+ * La arista que la realice tiene al menos un extremo sin etiquetar; el otro
+ * está sin etiquetar o es un vértice etiquetado con vecinos pendientes.
+ */
+static inline bool lookahead_dead(const labeler_t *L) {
+    uint64_t unused = L->labels & ~L->used;
+    uint64_t avail = unused | L->frontier;
+    uint64_t large = L->free_diffs & L->lookahead_mask;
+
+    while (large) {
+        int d = __builtin_ctzll(large);
+        large &= large - 1;
+        if (!((unused & (avail >> d)) | (avail & (unused >> d)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Siguiente valor del generador xorshift64.
+ */
+static inline uint64_t next_random(labeler_t *L) {
+    L->rng ^= L->rng << 13;
+    L->rng ^= L->rng >> 7;
+    L->rng ^= L->rng << 17;
+    return L->rng;
+}
+
+/**
+ * @brief Cuenta un nodo y, en un intento con presupuesto, lo abandona si se agotó.
+ * @return true si hay que volver sin explorar el nodo.
+ */
+static inline bool visit(labeler_t *L) {
+    if (++L->out->nodes >= L->node_limit) {
+        L->out_of_budget = true;
+        L->stop = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Guarda el etiquetado completo actual. Las hojas de cada padre reciben
+ *        sus etiquetas en orden creciente.
+ */
+static void record(labeler_t *L) {
+    tree_result_t *out = L->out;
+    int cursor[TREE_MAX_VERTICES];
+
+    out->found = true;
+    for (int i = 0; i < L->first_leaf; i++) {
+        out->labels[L->order[i]] = L->label[i];
+        cursor[i] = L->leaf_start[i];
+    }
+    for (uint64_t leaves = L->leaf_labels; leaves; leaves &= leaves - 1) {
+        int label = __builtin_ctzll(leaves);
+        out->labels[L->order[cursor[L->leaf_parent[label]]++]] = label;
+    }
+}
+
+/**
+ * @brief Entrega una etiqueta a una hoja del padre con etiqueta x y sigue con las demás.
+ */
+static void label_leaves(labeler_t *L, int left);
+
+static void place_leaf(labeler_t *L, int x, int next, int d, int left) {
+    int p = L->owner[x];
+    uint64_t frontier = L->frontier;
+    L->used |= BIT(next);
+    L->leaf_labels |= BIT(next);
+    L->leaf_parent[next] = p;
+    L->free_diffs &= ~BIT(d);
+    if (--L->pending[p] == 0) {
+        L->frontier &= ~BIT(x);
+    }
+
+    label_leaves(L, left - 1);
+
+    L->pending[p]++;
+    L->frontier = frontier;
+    L->free_diffs |= BIT(d);
+    L->leaf_labels &= ~BIT(next);
+    L->used &= ~BIT(next);
+}
+
+/**
+ * @brief Indica si el nuevo mínimo de opciones reemplaza al actual.
+ *
+ * En los reinicios los empates se eligen al azar (muestreo de reservorio).
+ */
+static inline bool better_choice(labeler_t *L, int options, int *best, int *ties) {
+    if (options < *best) {
+        *best = options;
+        *ties = 1;
+        return true;
+    }
+    return options == *best && L->randomize && next_random(L) % (uint64_t)++*ties == 0;
+}
+
+/**
+ * @brief Fase de hojas: reparte las diferencias libres entre las hojas pendientes.
+ *
+ * Con todos los vértices internos etiquetados, cada arista restante une un
+ * padre etiquetado con una hoja. Quedan tantas etiquetas libres como hojas y
+ * como diferencias libres, así que cada diferencia d necesita un padre x con
+ * hojas pendientes y x-d o x+d libre, y cada etiqueta libre y necesita un
+ * padre x con |x - y| libre. Se corta si alguna no tiene opciones y se
+ * ramifica sobre la diferencia o la etiqueta con menos. Como solo importa qué
+ * etiquetas recibe cada padre, cada conjunto de etiquetas de hojas hermanas se
+ * genera una sola vez.
+ *
+ * @param left Hojas sin etiquetar.
+ */
+static void label_leaves(labeler_t *L, int left) {
+    tree_result_t *out = L->out;
+    if (visit(L)) return;
+
+    if (left == 0) {
+        out->canonical += L->weight;
+        if (!out->found) {
+            record(L);
+        }
+        L->stop = L->find;
+        return;
+    }
+
+    uint64_t unused = L->labels & ~L->used;
+    uint64_t best_up = 0, best_down = 0;
+    int best_d = 0, best_label = -1, best_options = TREE_MAX_VERTICES * 2 + 1, ties = 0;
+
+    for (uint64_t free_diffs = L->free_diffs; free_diffs; free_diffs &= free_diffs - 1) {
+        int d = __builtin_ctzll(free_diffs);
+        uint64_t up = L->frontier & (unused >> d);     // padre x con x+d libre
+        uint64_t down = unused & (L->frontier >> d);   // etiqueta y libre con padre y+d
+        int options = __builtin_popcountll(up) + __builtin_popcountll(down);
+        if (options == 0) {
+            out->lookahead_cuts++;
+            return;
+        }
+        if (better_choice(L, options, &best_options, &ties)) {
+            best_d = d;
+            best_up = up;
+            best_down = down;
+        }
+    }
+
+    for (uint64_t labels = unused; labels; labels &= labels - 1) {
+        int y = __builtin_ctzll(labels);
+        int options = 0;
+        for (uint64_t parents = L->frontier; parents; parents &= parents - 1) {
+            int x = __builtin_ctzll(parents);
+            options += (L->free_diffs >> (x > y ? x - y : y - x)) & 1;
+        }
+        if (options == 0) {
+            out->lookahead_cuts++;
+            return;
+        }
+        if (better_choice(L, options, &best_options, &ties)) {
+            best_label = y;
+        }
+    }
+
+    if (best_label >= 0) {
+        // Ramificar sobre el padre de la etiqueta más restringida
+        int y = best_label;
+        for (uint64_t parents = L->frontier; parents; parents &= parents - 1) {
+            int x = __builtin_ctzll(parents);
+            int d = x > y ? x - y : y - x;
+            if (!(L->free_diffs & BIT(d))) continue;
+            place_leaf(L, x, y, d, left);
+            if (L->stop) return;
+        }
+        return;
+    }
+
+    // Ramificar sobre la realización de la diferencia más restringida
+    int d = best_d;
+    int first_side = L->randomize ? (int)(next_random(L) & 1) : 0;
+    for (int i = 0; i < 2; i++) {
+        int side = first_side ^ i;
+        for (uint64_t pick = side ? best_down : best_up; pick; pick &= pick - 1) {
+            int bit = __builtin_ctzll(pick);
+            if (side) {
+                place_leaf(L, bit + d, bit, d, left);
+            } else {
+                place_leaf(L, bit, bit + d, d, left);
+            }
+            if (L->stop) return;
+        }
+    }
+}
+
+/**
+ * @brief Fase interna: etiqueta el vértice de la posición k con etiqueta_padre ± d.
+ *
+ * Las diferencias se prueban de mayor a menor: las grandes tienen pocas
+ * parejas posibles y conviene usarlas mientras quedan etiquetas extremas. En
+ * los reinicios se sortea cuál de los dos candidatos se prueba primero.
+ */
+static void label_from(labeler_t *L, int k) {
+    if (k == L->first_leaf) {
+        label_leaves(L, L->vertices - k);
+        return;
+    }
+
+    tree_result_t *out = L->out;
+    if (visit(L)) return;
+
+    if (L->lookahead && lookahead_dead(L)) {
+        out->lookahead_cuts++;
+        return;
+    }
+
+    int p = L->parent[k];
+    int x = L->label[p];
+    // Hojas hermanas: diferencias decrecientes, así cada conjunto de etiquetas sale una vez
+    uint64_t allowed = L->sibling[k] >= 0 ? BIT(L->diff[L->sibling[k]]) - 1 : ~(uint64_t)0;
+
+    int first_side = L->randomize ? (int)(next_random(L) & 1) : 0;
+    uint64_t pending = L->free_diffs & allowed;
+    while (pending) {
+        int d = 63 - __builtin_clzll(pending);
+        pending &= ~BIT(d);
+
+        for (int i = 0; i < 2; i++) {
+            int side = first_side ^ i;
+            int next = side ? x + d : x - d;
+            if (next < 0 || next > L->m || (L->used & BIT(next))) continue;
+
+            // Colocar
+            uint64_t frontier = L->frontier;
+            L->label[k] = next;
+            L->diff[k] = d;
+            L->owner[next] = k;
+            L->used |= BIT(next);
+            L->free_diffs &= ~BIT(d);
+            if (--L->pending[p] == 0) {
+                L->frontier &= ~BIT(x);
+            }
+            if (L->pending[k] > 0) {
+                L->frontier |= BIT(next);
+            }
+
+            label_from(L, k + 1);
+
+            // Deshacer
+            L->pending[p]++;
+            L->frontier = frontier;
+            L->free_diffs |= BIT(d);
+            L->used &= ~BIT(next);
+            if (L->stop) return;
+        }
+    }
+}
+
+void tree_label(const tree_t *t, const tree_options_t *opt, tree_result_t *out) {
+    labeler_t L;
+    memset(&L, 0, sizeof(L));
+    memset(out, 0, sizeof(*out));
+    L.out = out;
+    L.vertices = t->vertices;
+    L.m = t->vertices - 1;
+    L.labels = L.m == 63 ? ~(uint64_t)0 : BIT(L.m + 1) - 1;    // etiquetas 0..m
+    L.find = opt->find;
+    L.lookahead = opt->lookahead;
+
+    int min_diff = opt->lookahead_min_diff > 0 ? opt->lookahead_min_diff : (L.m + 1) / 2;
+    if (min_diff < 1) min_diff = 1;
+    uint64_t diffs = L.labels & ~BIT(0);                           // diferencias 1..m
+    L.lookahead_mask = min_diff > L.m ? 0 : diffs & ~(BIT(min_diff) - 1);
+
+    // Contando se recorre todo una vez. Buscando, el tiempo hasta el primer
+    // etiquetado tiene cola pesada (un mal comienzo puede costar horas), así que
+    // se hacen intentos con presupuesto de nodos alternando los dos órdenes: el
+    // de profundidad resuelve las orugas al primer descenso y el de conteo, con
+    // su fase de hojas, suele ganar en árboles irregulares. Desde el tercer
+    // intento los candidatos se ordenan con azar y el presupuesto se duplica
+    // cada dos intentos; como crece sin límite, la búsqueda sigue siendo completa.
+    L.rng = 0x9E3779B97F4A7C15ull;
+    uint64_t budget = FIND_FIRST_BUDGET;
+    out->nodes = 1; // raíz (sin etiquetas)
+    for (int attempt = 0; ; attempt++) {
+        if (opt->find && attempt % 2 == 0) {
+            build_find_order(t, &L);
+        } else {
+            build_order(t, &L);
+        }
+        for (int k = 0; k < L.vertices; k++) {
+            // Todos los vecinos de un vértice, salvo su padre, van después en el orden
+            L.pending[k] = t->degree[L.order[k]] - (k > 0);
+        }
+        L.node_limit = opt->find ? out->nodes + budget : UINT64_MAX;
+        L.randomize = attempt > 1;
+        L.stop = false;
+        L.out_of_budget = false;
+
+        int roots = L.m / 2 + 1;
+        int shift = L.randomize ? (int)(next_random(&L) % (uint64_t)roots) : 0;
+        for (int i = 0; i < roots && !L.stop; i++) {
+            int r = (i + shift) % roots;
+            L.weight = 2 * r == L.m ? 1 : 2;
+            L.label[0] = r;
+            L.owner[r] = 0;
+            L.used = BIT(r);
+            L.free_diffs = diffs;
+            L.frontier = L.pending[0] > 0 ? BIT(r) : 0;
+            label_from(&L, 1);
+        }
+        if (!L.out_of_budget) {
+            break;
+        }
+        out->restarts++;
+        if (attempt % 2 == 1 && budget <= UINT64_MAX / 4) {
+            budget *= 2;
+        }
+    }
+
+    if (__builtin_mul_overflow(out->canonical, out->multiplier, &out->count)) {
+        out->overflow = true;
+    }
+}
+
+bool tree_verify(const tree_t *t, const int *labels) {
+    int m = t->vertices - 1;
+    uint64_t seen_labels = 0, seen_diffs = 0;
+
+    for (int v = 0; v < t->vertices; v++) {
+        if (labels[v] < 0 || labels[v] > m || (seen_labels & BIT(labels[v]))) return false;
+        seen_labels |= BIT(labels[v]);
+        for (uint64_t nb = t->adjacent[v]; nb; nb &= nb - 1) {
+            int u = __builtin_ctzll(nb);
+            if (u < v) continue;
+            int d = abs(labels[u] - labels[v]);
+            if (d == 0 || (seen_diffs & BIT(d))) return false;
+            seen_diffs |= BIT(d);
+        }
+    }
+    return __builtin_popcountll(seen_diffs) == m;
+}
@@ -1,16 +1,67 @@
 struct Sample {
   uint32_t delta;  // 4 bytes
   uint8_t pwm;     // 1 byte
-  uint16_t rpm;    // 2 bytes
+  uint16_t rpm;    // 2 bytes (+1 de relleno: 8 bytes por muestra)
 };
 
-const int maxSamples = 9371;
-Sample buffer[maxSamples];
-int bufferIndex = 0;
+// Codificación compacta (la misma de Completo.ino): registros varint en vez de
+// Sample. Par = muestra (cambio de RPM en zigzag, el tiempo avanza sampleInterval);
+// impar = evento (bits 1-2: 0 PWM, 1 muestra atrasada arg ms, 2 tiempo absoluto).
+// Una muestra típica ocupa 1 byte, así que la misma RAM guarda unas 8 veces más.
+const uint8_t eventPwm = 0;
+const uint8_t eventGap = 1;
+const uint8_t eventTime = 2;
+const unsigned long sampleInterval = 5;   // Período nominal del muestreo simulado (ms)
+
+const int bufferBytes = 9371 * sizeof(Sample); // La RAM que ocupaban 9371 muestras
+uint8_t buffer[bufferBytes];
+int bufferLength = 0;
+uint32_t sampleCount = 0;
+Sample lastStored;
+bool bufferFull = false;
 
 unsigned long startTime;
 bool sentCSV = false;
 
+int putVarint(uint8_t *p, uint32_t v) {
+  int n = 0;
+  while (v >= 0x80) {
+    p[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+int putEvent(uint8_t *p, uint8_t type, uint32_t arg) {
+  return putVarint(p, (arg << 3) | ((uint32_t)type << 1) | 1);
+}
+
+// Codifica una muestra respecto de la anterior (la primera lleva tiempo y PWM absolutos)
+int encodeSample(const Sample &s, uint8_t *out, bool first) {
+  int n = 0;
+  uint16_t rpmRef = 0;
+  if (first) {
+    n += putEvent(out + n, eventTime, s.delta);
+    n += putEvent(out + n, eventPwm, s.pwm);
+  } else {
+    if (s.pwm != lastStored.pwm) {
+      n += putEvent(out + n, eventPwm, s.pwm);
+    }
+    uint32_t expected = lastStored.delta + sampleInterval;
+    if (s.delta > expected) {
+      n += putEvent(out + n, eventGap, s.delta - expected);
+    } else if (s.delta != expected) {
+      n += putEvent(out + n, eventTime, s.delta);
+    }
+    rpmRef = lastStored.rpm;
+  }
+  int32_t d = (int32_t)s.rpm - rpmRef;
+  uint32_t zigzag = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+  n += putVarint(out + n, zigzag << 1);
+  return n;
+}
+
 void setup() {
   Serial.begin(115200);
   startTime = millis();
@@ -18,25 +69,57 @@ void setup() {
 
 void loop() {
   // Guardar datos si aún hay espacio
-  if (bufferIndex < maxSamples) {
+  if (!bufferFull) {
     Sample s;
     s.delta = millis() - startTime;
     s.pwm = 50;         // Simulación de PWM
     s.rpm = 1500;     // Simulación de RPM
 
-    buffer[bufferIndex++] = s;
-    delay(5); // Simular toma de datos
+    uint8_t record[10];
+    int n = encodeSample(s, record, bufferLength == 0);
+    if (bufferLength + n <= bufferBytes) {
+      memcpy(buffer + bufferLength, record, n);
+      bufferLength += n;
+      lastStored = s;
+      sampleCount++;
+      delay(5); // Simular toma de datos
+    } else {
+      bufferFull = true;
+    }
   }
   // Cuando el buffer esté lleno, mandar los datos si aún no se han enviado
   else if (!sentCSV) {
     Serial.println("delta;pwm;rpm"); // Encabezado CSV
 
-    for (int i = 0; i < maxSamples; i++) {
-      Serial.print(buffer[i].delta);
+    // Decodificar en orden: los eventos ajustan la próxima muestra
+    Sample s = {0, 0, 0};
+    bool timeSet = false;
+    int pos = 0;
+    while (pos < bufferLength) {
+      uint32_t v = 0;
+      for (int shift = 0; pos < bufferLength; shift += 7) {
+        uint8_t b = buffer[pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+      }
+      if (v & 1) {
+        uint32_t arg = v >> 3;
+        uint8_t type = (v >> 1) & 3;
+        if (type == eventPwm) s.pwm = arg;
+        else if (type == eventGap) { s.delta += sampleInterval + arg; timeSet = true; }
+        else if (type == eventTime) { s.delta = arg; timeSet = true; }
+        continue;
+      }
+      if (!timeSet) s.delta += sampleInterval;
+      timeSet = false;
+      uint32_t zigzag = v >> 1;
+      s.rpm += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+
+      Serial.print(s.delta);
       Serial.print(";");
-      Serial.print(buffer[i].pwm);
+      Serial.print(s.pwm);
       Serial.print(";");
-      Serial.println(buffer[i].rpm);
+      Serial.println(s.rpm);
     }
 
     sentCSV = true;
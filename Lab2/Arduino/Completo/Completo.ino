@@ -8,8 +8,38 @@
  * ante diferentes valores de PWM. Ofrece dos modos de operación:
  * 1. Control manual de PWM con visualización en tiempo real de las RPM
  * 2. Prueba automática con escalones de PWM y captura de datos
+ *
+ * Los comandos llegan como líneas de texto ("START 20", "PWM 50", "STOP",
+ * "STATUS"...) o como comandos binarios de 6 bytes con acuse
+ * (comandos_binarios.py), sin usar el heap y con tiempo de atención acotado.
+ *
+ * Las RPM se miden por defecto con el método M/T (comando "RPM MT"): la
+ * interrupción del encoder marca cada flanco con micros() y cada muestra
+ * divide los pulsos de la ventana por el tiempo entre el último flanco de la
+ * ventana anterior y el de esta. "RPM CONTEO" vuelve a la fórmula original
+ * (pulsos de la ventana * 60 / pulsos por revolución). simular_rpm.py compara
+ * los dos con trenes de pulsos sintéticos.
+ *
+ * El muestreo cada 4 ms y los escalones de PWM cada 2000 ms los hace un
+ * temporizador por hardware (alarma repetitiva del SDK), que deja cada
+ * medición en una cola sin bloqueos; loop() calcula las RPM y guarda las
+ * muestras. Así los comandos y el envío por serial no atrasan ni saltan
+ * muestras. Se mide el atraso de cada muestra respecto de su momento
+ * programado (STATUS, cierre de la exportación y, con "JITTER ON", una
+ * columna error_us por muestra) para comprobar que queda por debajo de un
+ * período del encoder.
+ *
+ * Los datos se envían mientras se capturan, como CSV (por defecto) o en
+ * paquetes binarios con CRC (comando "FORMAT BIN"), que decodificar_binario.py
+ * convierte al mismo CSV. La captura usa dos mitades de búfer: una se llena al
+ * ritmo del muestreo mientras la otra se envía sin bloquear, así que la
+ * duración de la prueba solo la limita el ancho de banda del enlace.
  */
 
+#include <pico/time.h>
+#include <hardware/pwm.h>
+#include <hardware/sync.h>
+
 // ------------------ CONFIGURACIÓN DE PINES ------------------
 const int in1Pin = 2;   ///< Pin de dirección 1 del puente H (L298N)
 const int in2Pin = 3;   ///< Pin de dirección 2 del puente H
@@ -18,6 +48,8 @@ const int enAPin = 4;   ///< Pin PWM para control de velocidad
 // ------------------ CONFIGURACIÓN DEL ENCODER ------------------
 const int encoderPin = 5;           ///< Pin de entrada del encoder óptico
 const int pulsesPerRevolution = 20; ///< Pulsos por revolución del encoder
+const unsigned long stallTimeoutUs = 500000; ///< Sin flancos por este tiempo se considera detenido (6 RPM)
+const unsigned long minEdgePeriodUs = 150;   ///< Período mínimo creíble entre flancos (20000 RPM); más cerca es un rebote y se ignora
 
 /**
  * @struct Sample
@@ -29,22 +61,184 @@ struct Sample {
   uint16_t rpm;    ///< RPM medidos
 };
 
+// ------------------ CODIFICACIÓN COMPACTA ------------------
+// Las muestras se guardan como una secuencia de registros varint (LEB128) en
+// bloques de blockBytes bytes, en vez de un Sample de 8 bytes con relleno:
+//   - par:   muestra; el valor / 2 es el cambio de RPM en zigzag respecto de la
+//            muestra anterior, y el tiempo avanza un sampleInterval.
+//   - impar: evento; bits 1-2 = tipo, resto = argumento:
+//            0 = PWM de las muestras siguientes, 1 = la próxima muestra llega
+//            sampleInterval + arg ms después de la anterior (muestreo atrasado),
+//            2 = tiempo absoluto de la próxima muestra, 3 = atraso del
+//            muestreo de la próxima muestra en us, en zigzag (solo con "JITTER ON").
+// Cada bloque empieza con el tiempo absoluto y el PWM de su primera muestra, y
+// las RPM parten de 0, así que se decodifica solo (un paquete binario perdido
+// no arruina los siguientes). Una muestra típica ocupa 1 byte; los eventos de
+// PWM aparecen una vez cada stepInterval.
+const uint8_t eventPwm = 0;     ///< Evento: nuevo PWM
+const uint8_t eventGap = 1;     ///< Evento: muestra atrasada
+const uint8_t eventTime = 2;    ///< Evento: tiempo absoluto
+const uint8_t eventTiming = 3;  ///< Evento: atraso del muestreo
+const int blockBytes = 224;     ///< Bytes de un bloque (la carga de un paquete binario)
+const int maxRecordBytes = 15;  ///< Tiempo (5) + PWM (2) + atraso (5) + muestra (3)
+
 // ------------------ PARÁMETROS DEL SISTEMA ------------------
-const int maxSamples = 7000;       ///< Máximo número de muestras a almacenar
-Sample buffer[maxSamples];         ///< Buffer para almacenamiento de datos
-int bufferIndex = 0;               ///< Índice actual del buffer
+// Doble búfer: el muestreo llena blocks[fillHalf] mientras loop() envía
+// blocks[drainHalf] en pedazos que caben en el búfer de transmisión, sin
+// bloquear. Si el enlace no alcanza a vaciar una mitad antes de que se llene
+// la otra, las muestras nuevas se descartan y se cuentan.
+const int halfBlocks = 9;                    ///< Bloques por mitad (~8 s a 250 Hz con 1 byte por muestra)
+uint8_t blocks[2][halfBlocks][blockBytes];   ///< Las dos mitades del búfer de captura
+uint8_t blockLength[2][halfBlocks];          ///< Bytes usados de cada bloque
+int halfBlocksUsed[2] = {0, 0};              ///< Bloques abiertos en cada mitad
+bool halfFull[2] = {false, false};           ///< Mitad cerrada, esperando su envío
+int fillHalf = 0;                  ///< Mitad que se está llenando
+int drainHalf = 0;                 ///< Mitad que se está enviando (o la próxima)
+int drainBlock = 0;                ///< Bloque de drainHalf que se está enviando
+Sample lastStored;                 ///< Última muestra guardada (referencia de la codificación)
+uint32_t storedSamples = 0;        ///< Muestras guardadas en la captura actual
+uint32_t droppedSamples = 0;       ///< Muestras descartadas por enlace lento o con la cola del muestreo llena
+bool endQueued = false;            ///< El cierre de la exportación ya está en txBuffer
+
+/**
+ * @struct BlockReader
+ * @brief Posición de lectura dentro de un bloque codificado
+ */
+struct BlockReader {
+  const uint8_t *data; ///< Bloque
+  int length;          ///< Bytes válidos
+  int offset;          ///< Próximo byte a leer
+  Sample next;         ///< Tiempo, PWM y RPM de referencia de la próxima muestra
+  bool timeSet;        ///< Un evento ya fijó el tiempo de la próxima muestra
+  bool timingPending;  ///< Un evento ya fijó el atraso de la próxima muestra
+  bool hasTiming;      ///< La muestra devuelta trae su atraso en timingUs
+  int32_t timingUs;    ///< Atraso del muestreo de la muestra devuelta
+};
+BlockReader reader;    ///< Lectura del bloque que se envía como CSV
 
 volatile unsigned int pulseCount = 0; ///< Contador de pulsos del encoder
+volatile uint32_t lastEdgeUs = 0;     ///< Momento del último flanco (micros())
+
+// ------------------ MUESTREO POR TEMPORIZADOR ------------------
+/**
+ * @struct TimerSample
+ * @brief Medición del temporizador, en espera de que loop() la procese
+ */
+struct TimerSample {
+  uint32_t sampleUs;  ///< Momento de la medición (time_us_32())
+  uint32_t edgeUs;    ///< Momento del último flanco del encoder
+  int32_t errorUs;    ///< Atraso respecto del momento programado
+  uint32_t tick;      ///< Número de muestra dentro de la captura
+  uint16_t count;     ///< Pulsos en la ventana
+  uint8_t pwm;        ///< PWM aplicado durante la ventana
+  bool capture;       ///< La tomó una captura en curso
+};
+// Cola de un productor (la alarma) y un consumidor (loop()): solo la alarma
+// escribe queueHead y solo loop() escribe queueTail; los índices corren libres.
+const int sampleQueueSize = 64;          ///< Potencia de 2: 256 ms de margen para loop()
+TimerSample sampleQueue[sampleQueueSize]; ///< Mediciones pendientes
+volatile uint32_t queueHead = 0;         ///< Próxima posición a escribir (solo la alarma)
+volatile uint32_t queueTail = 0;         ///< Próxima posición a leer (solo loop())
+volatile uint32_t queueOverflows = 0;    ///< Mediciones perdidas con la cola llena
+volatile uint32_t captureOverflows = 0;  ///< De queueOverflows, las que eran muestras de una captura
+uint32_t countedOverflows = 0;           ///< captureOverflows ya sumadas a droppedSamples (solo loop())
+repeating_timer_t sampleTimer;           ///< Alarma repetitiva del muestreo
+bool samplingTimerOk = false;            ///< La alarma se pudo programar (sin ella no hay muestreo)
+uint32_t nextSampleUs = 0;               ///< Momento programado de la próxima medición (solo la alarma)
+bool timerStarted = false;               ///< Ya hubo una medición (solo la alarma)
+volatile bool timerCapturing = false;    ///< La alarma lleva la secuencia de PWM de una captura
+uint32_t captureTick = 0;                ///< Muestras de la captura (solo la alarma mientras captura)
+
+bool logJitter = false;        ///< Guardar el atraso de cada muestra en la captura
+int32_t jitterMaxUs = 0;       ///< Mayor atraso del muestreo desde START
+uint32_t jitterOverPeriod = 0; ///< Muestras con un atraso de al menos un período del encoder
+
+bool periodRpm = true;     ///< RPM por el método M/T; false: conteo por ventana
+uint32_t refEdgeUs = 0;    ///< Último flanco de la ventana anterior con flancos
+bool haveRefEdge = false;  ///< refEdgeUs es válido (hubo un flanco desde la última detención)
+float mtRpm = 0;           ///< Última estimación M/T
+
+// ------------------ EXPORTACIÓN BINARIA ------------------
+// Paquete de tamaño fijo (little-endian):
+//   magia A5 5A | tipo (1) | secuencia (2) | bytes válidos (1) | carga (224) | CRC-16 (2)
+// La carga de un paquete de datos es un bloque de la codificación compacta,
+// tal como quedó en RAM; los bytes sobrantes van en cero. El CRC-16/CCITT-FALSE
+// cubre desde el tipo hasta el final de la carga. Secuencia: inicio = 0,
+// datos = 1..N, fin = N + 1. Como la captura se envía mientras ocurre, el
+// total de muestras llega en el paquete de fin, junto con las descartadas.
+const uint8_t frameMagic[2] = {0xA5, 0x5A}; ///< Marca de comienzo de paquete
+const uint8_t frameStart = 1;               ///< Paquete de inicio: total (0, desconocido), intervalo, paso, versión
+const uint8_t frameData = 2;                ///< Paquete de datos
+const uint8_t frameEnd = 3;                 ///< Paquete de fin: totales de muestras, paquetes y descartadas; atraso máximo y muestras sobre un período
+const uint8_t frameVersion = 4;             ///< Versión del formato (3: carga compacta; 4: atraso del muestreo)
+const int frameHeaderBytes = 6;             ///< Magia, tipo, secuencia y cantidad
+const int framePayloadBytes = blockBytes;   ///< 224 bytes
+const int frameBytes = frameHeaderBytes + framePayloadBytes + 2;      ///< 232 bytes con el CRC
+
+const int csvLineBytes = 36;                ///< Línea CSV más larga ("4294967295;255;65535;-2147483648\r\n" y el nulo)
+
+bool binaryExport = false; ///< Exportar en paquetes binarios en vez de CSV
+uint8_t txBuffer[frameBytes];  ///< Paquete o líneas CSV pendientes de escribir
+int txLength = 0;              ///< Bytes válidos en txBuffer
+int txPos = 0;                 ///< Bytes de txBuffer ya escritos
+uint16_t frameSeq = 0;         ///< Secuencia del próximo paquete binario
+
+// ------------------ COMANDOS ------------------
+// Texto: una línea ASCII terminada en '\n' o '\r' ("START 20", "PWM 50", "STOP",
+// "STATUS", "FORMAT BIN"...), acumulada en un búfer fijo sin usar el heap.
+// Binario (6 bytes, little-endian): A5 | código | argumento (2) | CRC-16 (2),
+// con el CRC-16/CCITT-FALSE del código y el argumento. Cada comando binario se
+// responde con un acuse de 10 bytes:
+//   5A A5 | código | resultado | estado | pwm | rpm (2) | CRC-16 (2)
+// Un 0xA5 al comienzo de una línea abre un comando binario (no es ASCII).
+// loop() lee como mucho maxInputBytesPerLoop bytes por vuelta y las respuestas
+// se escriben sin bloquear (entre paquetes si hay una captura en curso), así
+// que atender comandos nunca atrasa una muestra.
+const int maxCommandLength = 31;           ///< Caracteres de una línea de texto
+const int maxInputBytesPerLoop = 32;       ///< Bytes de entrada procesados por vuelta de loop()
+const uint8_t commandMagic = 0xA5;         ///< Primer byte de un comando binario
+const uint8_t ackMagic[2] = {0x5A, 0xA5};  ///< Marca de un acuse
+const int commandBytes = 6;                ///< Tamaño de un comando binario
+const int ackBytes = 10;                   ///< Tamaño de un acuse
+const unsigned long commandTimeout = 50;   ///< ms para completar un comando binario empezado
+
+const uint8_t cmdStart = 1;   ///< START: argumento = paso de PWM
+const uint8_t cmdPwm = 2;     ///< PWM manual: argumento = PWM (0-100)
+const uint8_t cmdStop = 3;    ///< STOP: detiene el motor (y termina la captura)
+const uint8_t cmdStatus = 4;  ///< STATUS: solo el acuse con el estado
+
+const uint8_t resultOk = 0;          ///< Comando ejecutado
+const uint8_t resultBusy = 1;        ///< No se puede en el estado actual (captura en curso)
+const uint8_t resultBadCrc = 2;      ///< CRC incorrecto: comando ignorado
+const uint8_t resultUnknown = 3;     ///< Código desconocido
+
+char commandLine[maxCommandLength + 1]; ///< Línea de texto en curso
+int commandLength = 0;                  ///< Caracteres en commandLine
+bool commandOverflow = false;           ///< La línea superó maxCommandLength: se descarta
+uint8_t binaryCommand[commandBytes];    ///< Comando binario en curso
+int binaryLength = 0;                   ///< Bytes recibidos del comando binario
+unsigned long binaryStartTime = 0;      ///< Llegada del primer byte del comando binario
+
+// El texto deja siempre libres ackReserve bytes: un STATUS largo o varias
+// respuestas seguidas no impiden encolar los acuses de los comandos binarios.
+const int replyBytes = 256;                ///< Tamaño de replyBuffer
+const int ackReserve = 4 * ackBytes;       ///< Bytes de replyBuffer reservados para acuses
+const int statusBytes = 160;               ///< Línea de STATUS más larga (cabe en replyBytes - ackReserve)
+
+uint8_t replyBuffer[replyBytes]; ///< Respuestas pendientes (texto y acuses)
+int replyLength = 0;          ///< Bytes válidos en replyBuffer
+int replyPos = 0;             ///< Bytes de replyBuffer ya escritos
+uint32_t droppedReplies = 0;  ///< Respuestas que no cupieron en replyBuffer
+unsigned long commandMaxUs = 0; ///< Peor tiempo de atención de comandos en una vuelta de loop()
+float lastRpm = 0;            ///< Última medición (para STATUS)
 
 // ------------------ VARIABLES DE TEMPORIZACIÓN ------------------
-unsigned long lastSampleTime = 0;  ///< Último tiempo de muestreo
-unsigned long lastStepTime = 0;    ///< Último cambio de paso PWM
 unsigned long lastPrintTime = 0;   ///< Último tiempo de impresión serial
-unsigned long startTime;           ///< Tiempo de inicio de prueba
 
 // Intervalos de tiempo (ms)
 const unsigned long sampleInterval = 4;   ///< Intervalo de muestreo de RPM (250Hz)
 const unsigned long stepInterval = 2000;  ///< Intervalo entre pasos PWM
+const uint32_t stepTicks = stepInterval / sampleInterval; ///< Muestras por paso PWM
 const unsigned long printInterval = 500;  ///< Intervalo de reporte serial (2Hz)
 
 // ------------------ ESTADOS DEL SISTEMA ------------------
@@ -59,22 +253,249 @@ enum State {
   SENDING     ///< Enviando datos capturados
 };
 
-State currentState = IDLE; ///< Estado actual del sistema
-int currentPWM = 0;        ///< Valor actual de PWM (0-100%)
-int pwmStep = 20;          ///< Tamaño de paso para pruebas automáticas
-bool descending = false;   ///< Indicador de secuencia descendente
+State currentState = IDLE;   ///< Estado actual del sistema
+volatile int currentPWM = 0; ///< Valor actual de PWM (0-100%); durante una captura lo cambia la alarma
+int pwmStep = 20;            ///< Tamaño de paso para pruebas automáticas
+bool descending = false;     ///< Indicador de secuencia descendente (de la alarma durante una captura)
 
 // ------------------ FUNCIONES ------------------
 
 /**
  * @brief Rutina de interrupción para el encoder
  * 
- * Incrementa el contador de pulsos en cada flanco ascendente
+ * Incrementa el contador de pulsos y guarda el momento de cada flanco ascendente.
+ * Un flanco a menos de minEdgePeriodUs del anterior es un rebote o ruido: no
+ * se cuenta ni mueve lastEdgeUs, así el conteo y el M/T ven solo flancos reales.
  */
 void countPulse() {
+  uint32_t now = micros();
+  if (now - lastEdgeUs < minEdgePeriodUs) {
+    return;
+  }
+  lastEdgeUs = now;
   pulseCount++;
 }
 
+/**
+ * @brief Redondea unas RPM a uint16_t, saturando en 0 y 65535
+ *
+ * Convertir un float fuera de rango a un entero sin signo es comportamiento
+ * indefinido, así que toda medición pasa por acá antes de guardarse o enviarse.
+ */
+uint16_t rpmToU16(float rpm) {
+  if (!(rpm > 0)) {
+    return 0;
+  }
+  return rpm >= 65535 ? 65535 : (uint16_t)(rpm + 0.5f);
+}
+
+/**
+ * @brief Estima las RPM por el método M/T
+ *
+ * Con M pulsos en la ventana, el tiempo T entre el último flanco de la
+ * ventana anterior y el último de esta abarca exactamente M períodos, así que
+ * RPM = M * 60e6 / (pulsos por revolución * T us). A alta velocidad se
+ * promedian muchos pulsos; a baja, la resolución la da micros() y no el
+ * largo de la ventana. En una ventana sin flancos el período es al menos el
+ * tiempo desde el último flanco, y la estimación no puede superar esa cota;
+ * después de stallTimeoutUs sin flancos el motor se da por detenido. Los
+ * rebotes ya los filtra countPulse().
+ * @param count Pulsos de la ventana
+ * @param edgeUs Momento del último flanco
+ * @param nowUs Momento actual
+ * @return RPM estimadas
+ */
+float measureRpmMT(unsigned int count, uint32_t edgeUs, uint32_t nowUs) {
+  if (count > 0) {
+    uint32_t span = edgeUs - refEdgeUs;
+    if (haveRefEdge && span > 0) {
+      mtRpm = count * 60e6f / (pulsesPerRevolution * (float)span);
+    }
+    refEdgeUs = edgeUs;
+    haveRefEdge = true;
+  } else if (haveRefEdge) {
+    uint32_t since = nowUs - refEdgeUs;
+    if (since >= stallTimeoutUs) {
+      mtRpm = 0;
+      haveRefEdge = false;
+    } else {
+      float bound = 60e6f / (pulsesPerRevolution * (float)since);
+      if (bound < mtRpm) {
+        mtRpm = bound;
+      }
+    }
+  }
+  return mtRpm;
+}
+
+/**
+ * @brief Aplica un PWM escribiendo directamente el nivel del canal
+ *
+ * analogWrite() configura el pin y la frecuencia en setup(); después basta con
+ * el registro de comparación, que se puede escribir desde la alarma.
+ * @param percent PWM en % (0-100)
+ */
+void setPwmLevel(int percent) {
+  uint slice = pwm_gpio_to_slice_num(enAPin);
+  uint32_t top = pwm_hw->slice[slice].top;
+  pwm_set_gpio_level(enAPin, (top + 1) * percent / 100);
+}
+
+/**
+ * @brief Avanza la secuencia de PWM de la captura un escalón
+ * @return false si la secuencia terminó (motor detenido)
+ */
+bool stepPwm() {
+  int pwm = currentPWM;
+  if (!descending) {
+    // Fase ascendente
+    pwm += pwmStep;
+    if (pwm > 100) {
+      pwm -= pwmStep;
+      descending = true;
+    }
+  } else {
+    // Fase descendente
+    pwm -= pwmStep;
+    if (pwm < 0) {
+      currentPWM = 0;
+      setPwmLevel(0);
+      return false;
+    }
+  }
+  currentPWM = pwm;
+  setPwmLevel(pwm);
+  return true;
+}
+
+/**
+ * @brief Muestreo y secuencia de PWM. Corre cada sampleInterval en la interrupción de la alarma
+ *
+ * Toma los pulsos y el último flanco del encoder, mide el atraso respecto del
+ * momento programado y deja la medición en sampleQueue. Durante una captura
+ * además aplica los escalones de PWM cada stepTicks muestras; al terminar la
+ * secuencia baja timerCapturing y loop() cierra la captura.
+ */
+bool onSampleTimer(repeating_timer_t *timer) {
+  (void)timer;
+  uint32_t now = time_us_32();
+  if (!timerStarted) {
+    nextSampleUs = now;
+    timerStarted = true;
+  }
+  int32_t error = (int32_t)(now - nextSampleUs);
+  nextSampleUs += sampleInterval * 1000;
+
+  // La interrupción del encoder y esta alarma corren en el núcleo 0 (las
+  // registra setup()): basta con enmascarar las interrupciones de este núcleo
+  uint32_t saved = save_and_disable_interrupts();
+  unsigned int count = pulseCount;
+  uint32_t edgeUs = lastEdgeUs;
+  pulseCount = 0;
+  restore_interrupts(saved);
+
+  TimerSample m;
+  m.sampleUs = now;
+  m.edgeUs = edgeUs;
+  m.errorUs = error;
+  m.count = count;
+  m.pwm = currentPWM;
+  m.tick = 0;
+  m.capture = timerCapturing;
+  if (m.capture) {
+    m.tick = captureTick++;
+    if (captureTick % stepTicks == 0 && !stepPwm()) {
+      timerCapturing = false;
+    }
+  }
+
+  uint32_t head = queueHead;
+  if (head - queueTail >= (uint32_t)sampleQueueSize) {
+    queueOverflows++;
+    if (m.capture) {
+      captureOverflows++;
+    }
+  } else {
+    sampleQueue[head & (sampleQueueSize - 1)] = m;
+    __dmb();  // La medición queda escrita antes de publicar el índice
+    queueHead = head + 1;
+  }
+  return true;  // Seguir repitiendo
+}
+
+/**
+ * @brief Acumula el atraso de una muestra y lo compara con el período del encoder
+ * @param errorUs Atraso del muestreo
+ * @param rpm RPM de la muestra
+ */
+void recordTiming(int32_t errorUs, float rpm) {
+  int32_t magnitude = errorUs < 0 ? -errorUs : errorUs;
+  if (magnitude > jitterMaxUs) {
+    jitterMaxUs = magnitude;
+  }
+  if (rpm > 0 && magnitude >= 60e6f / (pulsesPerRevolution * rpm)) {
+    jitterOverPeriod++;
+  }
+}
+
+/**
+ * @brief Suma a droppedSamples las muestras de la captura que la alarma no pudo encolar
+ */
+void countCaptureOverflows() {
+  uint32_t lost = captureOverflows;
+  droppedSamples += lost - countedOverflows;
+  countedOverflows = lost;
+}
+
+/**
+ * @brief Procesa las mediciones de la cola: RPM, captura y reporte manual
+ *
+ * Cuando la alarma terminó la secuencia y ya se guardaron todas sus muestras,
+ * cierra la captura.
+ */
+void processSamples() {
+  // Antes de vaciar la cola: si la secuencia ya había terminado, su última muestra está en la cola
+  bool sequenceDone = !timerCapturing;
+
+  while (queueTail != queueHead) {
+    uint32_t tail = queueTail;
+    __dmb();  // Leer la medición después de ver el índice que la publica
+    TimerSample m = sampleQueue[tail & (sampleQueueSize - 1)];
+    __dmb();
+    queueTail = tail + 1;
+
+    // Calcular RPM
+    float rpm = periodRpm ? measureRpmMT(m.count, m.edgeUs, m.sampleUs)
+                          : (m.count * 60.0) / pulsesPerRevolution;
+    lastRpm = rpm;
+    recordTiming(m.errorUs, rpm);
+
+    // Almacenar datos si estamos en modo captura
+    if (currentState == CAPTURING && m.capture) {
+      Sample s;
+      s.delta = m.tick * sampleInterval;
+      s.pwm = m.pwm;
+      s.rpm = rpmToU16(rpm);
+      storeSample(s, m.errorUs);
+    }
+
+    // Reportar estado en modo manual
+    unsigned long currentTime = millis();
+    if (currentState == MANUAL_PWM && currentTime - lastPrintTime >= printInterval) {
+      lastPrintTime = currentTime;
+      char line[48];
+      unsigned long centi = rpm * 100 + 0.5f;
+      snprintf(line, sizeof(line), "PWM: %d%% | RPM: %lu.%02lu\r\n", (int)currentPWM, centi / 100, centi % 100);
+      queueText(line);
+    }
+  }
+  countCaptureOverflows();
+
+  if (currentState == CAPTURING && sequenceDone) {
+    endCapture();
+  }
+}
+
 /**
  * @brief Configuración inicial del sistema
  * 
@@ -99,6 +520,14 @@ void setup() {
   // Configurar encoder
   pinMode(encoderPin, INPUT_PULLUP);
   attachInterrupt(digitalPinToInterrupt(encoderPin), countPulse, RISING);
+
+  // Muestreo por alarma (período negativo: cada sampleInterval desde el inicio anterior, sin deriva).
+  // Como la interrupción del encoder, corre en el núcleo que la registra (el 0): onSampleTimer()
+  // cuenta con eso para leer pulseCount y lastEdgeUs
+  samplingTimerOk = add_repeating_timer_us(-(int64_t)(sampleInterval * 1000), onSampleTimer, NULL, &sampleTimer);
+  if (!samplingTimerOk) {
+    queueText("❌ No se pudo programar la alarma de muestreo: sin RPM ni capturas\r\n");
+  }
 }
 
 /**
@@ -107,133 +536,662 @@ void setup() {
  * Gestiona la máquina de estados principal y las tareas periódicas
  */
 void loop() {
-  static String input = ""; // Buffer para entrada serial
-
-  // Procesar comandos seriales entrantes
-  while (Serial.available()) {
-    char c = Serial.read();
-    if (c == '\n') {
-      processCommand(input);
-      input = "";
+  // Procesar comandos seriales entrantes (tiempo acotado)
+  unsigned long commandStart = micros();
+  readCommands();
+  unsigned long commandUs = micros() - commandStart;
+  if (commandUs > commandMaxUs) {
+    commandMaxUs = commandUs;
+  }
+
+  // Mediciones del temporizador
+  processSamples();
+
+  // Envío en segundo plano de la mitad ya llena y de las respuestas
+  if (currentState == CAPTURING || currentState == SENDING) {
+    serviceStream();
+  } else {
+    flushReplies();
+  }
+}
+
+/**
+ * @brief Lee los bytes de entrada disponibles (hasta maxInputBytesPerLoop) y ejecuta los comandos completos
+ *
+ * Las líneas de texto se acumulan en commandLine (en mayúsculas y sin espacios
+ * iniciales); una línea demasiado larga se descarta entera. Un 0xA5 al
+ * comienzo de una línea abre un comando binario de commandBytes bytes, que se
+ * abandona si no se completa en commandTimeout ms.
+ */
+void readCommands() {
+  for (int i = 0; i < maxInputBytesPerLoop && Serial.available(); i++) {
+    uint8_t c = Serial.read();
+
+    if (binaryLength > 0) {
+      binaryCommand[binaryLength++] = c;
+      if (binaryLength == commandBytes) {
+        processBinaryCommand();
+        binaryLength = 0;
+      }
+    } else if (c == commandMagic && commandLength == 0 && !commandOverflow) {
+      binaryCommand[0] = c;
+      binaryLength = 1;
+      binaryStartTime = millis();
+    } else if (c == '\n' || c == '\r') {
+      if (commandOverflow) {
+        queueText("❌ Comando demasiado largo\r\n");
+      } else if (commandLength > 0) {
+        commandLine[commandLength] = '\0';
+        processCommand(commandLine);
+      }
+      commandLength = 0;
+      commandOverflow = false;
+    } else if (c == ' ' && commandLength == 0) {
+      // Espacios iniciales
+    } else if (commandLength < maxCommandLength) {
+      commandLine[commandLength++] = toupper(c);
     } else {
-      input += c;
+      commandOverflow = true;
     }
   }
 
-  unsigned long currentTime = millis();
+  if (binaryLength > 0 && millis() - binaryStartTime > commandTimeout) {
+    binaryLength = 0;  // Comando cortado: volver a texto
+  }
+}
 
-  // Muestreo periódico de RPM
-  if (currentTime - lastSampleTime >= sampleInterval) {
-    lastSampleTime = currentTime;
+/**
+ * @brief Devuelve el argumento de un comando de texto "NOMBRE argumento"
+ * @param cmd Línea en mayúsculas
+ * @param name Nombre del comando
+ * @return Puntero al argumento, o NULL si la línea no es ese comando con argumento
+ */
+const char *commandArg(const char *cmd, const char *name) {
+  size_t n = strlen(name);
+  if (strncmp(cmd, name, n) != 0 || cmd[n] != ' ') {
+    return NULL;
+  }
+  return cmd + n + 1;
+}
 
-    // Leer contador de pulsos de forma segura
-    noInterrupts();
-    unsigned int count = pulseCount;
-    pulseCount = 0;
-    interrupts();
+/**
+ * @brief Procesa un comando de texto
+ * @param cmd Línea recibida, en mayúsculas y terminada en nulo (se recortan los espacios finales)
+ */
+void processCommand(char *cmd) {
+  int n = strlen(cmd);
+  while (n > 0 && cmd[n - 1] == ' ') {
+    cmd[--n] = '\0';
+  }
+  bool busy = currentState == CAPTURING || currentState == SENDING;
+  const char *arg;
 
-    // Calcular RPM
-    float rpm = (count * 60.0) / pulsesPerRevolution;
+  if ((arg = commandArg(cmd, "START")) != NULL) {
+    // Iniciar secuencia de prueba automática
+    if (!busy && samplingTimerOk) {
+      queueText("📊 Iniciando captura de datos...\r\n");
+      startCapture(atoi(arg));
+    }
+  } else if ((arg = commandArg(cmd, "PWM")) != NULL) {
+    // Configurar PWM manualmente
+    if (setManualPwm(atoi(arg)) == resultOk) {
+      queueText("🕹️ Modo manual activado\r\n");
+    }
+  } else if (strcmp(cmd, "STOP") == 0) {
+    queueText(currentState == CAPTURING ? "⏹️ Captura detenida\r\n" : "⏹️ Motor detenido\r\n");
+    stopMotor();
+  } else if (strcmp(cmd, "STATUS") == 0) {
+    static const char *const stateNames[] = {"REPOSO", "MANUAL", "CAPTURANDO", "ENVIANDO"};
+    char line[statusBytes];
+    snprintf(line, sizeof(line),
+             "%s pwm=%d rpm=%u n=%lu desc=%lu cmd_us=%lu atraso_us=%ld sobre=%lu cola=%lu resp=%lu\r\n",
+             stateNames[currentState], (int)currentPWM, (unsigned)rpmToU16(lastRpm),
+             (unsigned long)storedSamples, (unsigned long)droppedSamples, commandMaxUs,
+             (long)jitterMaxUs, (unsigned long)jitterOverPeriod, (unsigned long)queueOverflows,
+             (unsigned long)droppedReplies);
+    queueText(line);
+  } else if (strcmp(cmd, "FORMAT BIN") == 0 && !busy) {
+    binaryExport = true;
+    queueText("📦 Exportación binaria\r\n");
+  } else if (strcmp(cmd, "FORMAT CSV") == 0 && !busy) {
+    binaryExport = false;
+    queueText("📄 Exportación CSV\r\n");
+  } else if (strcmp(cmd, "RPM MT") == 0 && !busy) {
+    periodRpm = true;
+    haveRefEdge = false;
+    mtRpm = 0;
+    queueText("⏱️ RPM por método M/T\r\n");
+  } else if (strcmp(cmd, "RPM CONTEO") == 0 && !busy) {
+    periodRpm = false;
+    queueText("🔢 RPM por conteo en la ventana\r\n");
+  } else if (strcmp(cmd, "JITTER ON") == 0 && !busy) {
+    logJitter = true;
+    queueText("⏱️ Atraso del muestreo por muestra (columna error_us)\r\n");
+  } else if (strcmp(cmd, "JITTER OFF") == 0 && !busy) {
+    logJitter = false;
+    queueText("⏱️ Sin atraso por muestra\r\n");
+  }
+}
 
-    // Almacenar datos si estamos en modo captura
-    if (currentState == CAPTURING && bufferIndex < maxSamples) {
-      Sample s;
-      s.delta = currentTime - startTime;
-      s.pwm = currentPWM;
-      s.rpm = rpm;
-      buffer[bufferIndex++] = s;
+/**
+ * @brief Verifica y ejecuta el comando binario de binaryCommand y encola su acuse
+ */
+void processBinaryCommand() {
+  uint8_t code = binaryCommand[1];
+  int arg = binaryCommand[2] | (binaryCommand[3] << 8);
+  uint16_t crc = binaryCommand[4] | (binaryCommand[5] << 8);
+  uint8_t result;
+
+  if (crc16Update(0xFFFF, binaryCommand + 1, 3) != crc) {
+    result = resultBadCrc;
+  } else if (code == cmdStart) {
+    result = startCapture(arg);
+  } else if (code == cmdPwm) {
+    result = setManualPwm(arg);
+  } else if (code == cmdStop) {
+    result = stopMotor();
+  } else if (code == cmdStatus) {
+    result = resultOk;
+  } else {
+    result = resultUnknown;
+  }
+
+  uint8_t ack[ackBytes];
+  uint16_t rpm = rpmToU16(lastRpm);
+  ack[0] = ackMagic[0];
+  ack[1] = ackMagic[1];
+  ack[2] = code;
+  ack[3] = result;
+  ack[4] = currentState;
+  ack[5] = (uint8_t)currentPWM;
+  putU16(ack + 6, rpm);
+  putU16(ack + 8, crc16Update(0xFFFF, ack + 2, ackBytes - 4));
+  queueReply(ack, ackBytes);
+}
+
+/**
+ * @brief Inicia la prueba automática
+ * @param step Paso de PWM (se limita a 1-100)
+ * @return resultOk, o resultBusy si ya hay una captura en curso (o no hay alarma de muestreo)
+ */
+uint8_t startCapture(int step) {
+  if (currentState == CAPTURING || currentState == SENDING || !samplingTimerOk) {
+    return resultBusy;
+  }
+  pwmStep = constrain(step, 1, 100);
+  currentPWM = 0;
+  descending = false;
+  setPwmLevel(0);
+  beginStream();
+  jitterMaxUs = 0;
+  jitterOverPeriod = 0;
+  captureTick = 0;
+  currentState = CAPTURING;
+  // captureTick, pwmStep y descending los lee la alarma: quedan escritos antes de habilitarla
+  __dmb();
+  timerCapturing = true;  // Desde acá la secuencia la lleva la alarma
+  return resultOk;
+}
+
+/**
+ * @brief Pasa al modo manual con un PWM fijo
+ * @param value PWM en % (se limita a 0-100)
+ * @return resultOk, o resultBusy durante una captura
+ */
+uint8_t setManualPwm(int value) {
+  if (currentState == CAPTURING || currentState == SENDING) {
+    return resultBusy;
+  }
+  currentPWM = constrain(value, 0, 100);
+  setPwmLevel(currentPWM);
+  currentState = MANUAL_PWM;
+  return resultOk;
+}
+
+/**
+ * @brief Detiene el motor; una captura en curso termina y envía lo capturado
+ * @return resultOk
+ */
+uint8_t stopMotor() {
+  timerCapturing = false;  // Primero: la alarma deja de cambiar el PWM
+  currentPWM = 0;
+  setPwmLevel(0);
+  if (currentState == CAPTURING) {
+    endCapture();
+  } else if (currentState == MANUAL_PWM) {
+    currentState = IDLE;
+  }
+  return resultOk;
+}
+
+/**
+ * @brief Agrega bytes a las respuestas pendientes sin pasar de @p limit bytes ocupados
+ *
+ * Si no caben se descartan enteros (y se cuentan en droppedReplies, que
+ * muestra STATUS) en vez de esperar al puerto.
+ */
+void appendReply(const uint8_t *data, int length, int limit) {
+  if (replyPos > 0) {
+    // Corre al principio lo que falta escribir
+    memmove(replyBuffer, replyBuffer + replyPos, replyLength - replyPos);
+    replyLength -= replyPos;
+    replyPos = 0;
+  }
+  if (replyLength + length > limit) {
+    droppedReplies++;
+    return;
+  }
+  memcpy(replyBuffer + replyLength, data, length);
+  replyLength += length;
+}
+
+/**
+ * @brief Agrega un acuse (puede usar todo replyBuffer)
+ */
+void queueReply(const uint8_t *data, int length) {
+  appendReply(data, length, replyBytes);
+}
+
+/**
+ * @brief Agrega una respuesta de texto (deja libres ackReserve bytes)
+ */
+void queueText(const char *text) {
+  appendReply((const uint8_t *)text, strlen(text), replyBytes - ackReserve);
+}
+
+/**
+ * @brief Escribe las respuestas pendientes que quepan en el búfer de transmisión
+ * @return true si quedan respuestas por escribir
+ */
+bool flushReplies() {
+  if (replyPos < replyLength) {
+    int room = Serial.availableForWrite();
+    if (room > 0) {
+      int n = min(room, replyLength - replyPos);
+      Serial.write(replyBuffer + replyPos, n);
+      replyPos += n;
     }
+  }
+  return replyPos < replyLength;
+}
 
-    // Reportar estado en modo manual
-    if (currentState == MANUAL_PWM && currentTime - lastPrintTime >= printInterval) {
-      lastPrintTime = currentTime;
-      Serial.print("PWM: ");
-      Serial.print(currentPWM);
-      Serial.print("% | RPM: ");
-      Serial.println(rpm);
+/**
+ * @brief Escribe un entero sin signo como varint (7 bits por byte, el bit alto indica que sigue)
+ * @return Bytes escritos (1 a 5)
+ */
+int putVarint(uint8_t *p, uint32_t v) {
+  int n = 0;
+  while (v >= 0x80) {
+    p[n++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+/**
+ * @brief Lee un varint sin pasarse del final del bloque
+ * @return false si el varint está cortado
+ */
+bool getVarint(const uint8_t *p, int length, int &offset, uint32_t &v) {
+  v = 0;
+  for (int shift = 0; offset < length && shift < 35; shift += 7) {
+    uint8_t b = p[offset++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      return true;
     }
   }
+  return false;
+}
 
-  // Secuencia de pasos durante captura
-  if (currentState == CAPTURING && millis() - lastStepTime >= stepInterval) {
-    lastStepTime = millis();
+/**
+ * @brief Codifica un entero con signo en zigzag (0, -1, 1, -2... -> 0, 1, 2, 3...)
+ */
+uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
 
-    if (!descending) {
-      // Fase ascendente
-      currentPWM += pwmStep;
-      if (currentPWM > 100) {
-        currentPWM -= pwmStep;
-        descending = true;
-      }
-    } else {
-      // Fase descendente
-      currentPWM -= pwmStep;
-      if (currentPWM < 0) {
-        currentPWM = 0;
-        analogWrite(enAPin, 0);
-        currentState = SENDING;
-        sendCSV();
+/**
+ * @brief Codifica un evento como varint impar
+ */
+int putEvent(uint8_t *p, uint8_t type, uint32_t arg) {
+  return putVarint(p, (arg << 3) | ((uint32_t)type << 1) | 1);
+}
+
+/**
+ * @brief Codifica una muestra respecto de la anterior guardada
+ * @param s Muestra
+ * @param timingUs Atraso del muestreo (se guarda solo con logJitter)
+ * @param out Destino (maxRecordBytes bytes)
+ * @param blockStart La muestra abre un bloque: tiempo y PWM absolutos, RPM desde 0
+ * @return Bytes escritos
+ */
+int encodeSample(const Sample &s, int32_t timingUs, uint8_t *out, bool blockStart) {
+  int n = 0;
+  uint16_t rpmRef = 0;
+  if (blockStart) {
+    n += putEvent(out + n, eventTime, s.delta);
+    n += putEvent(out + n, eventPwm, s.pwm);
+  } else {
+    if (s.pwm != lastStored.pwm) {
+      n += putEvent(out + n, eventPwm, s.pwm);
+    }
+    uint32_t expected = lastStored.delta + sampleInterval;
+    if (s.delta > expected) {
+      n += putEvent(out + n, eventGap, s.delta - expected);
+    } else if (s.delta != expected) {
+      n += putEvent(out + n, eventTime, s.delta);
+    }
+    rpmRef = lastStored.rpm;
+  }
+  if (logJitter) {
+    n += putEvent(out + n, eventTiming, zigzag(timingUs));
+  }
+  n += putVarint(out + n, zigzag((int32_t)s.rpm - rpmRef) << 1);
+  return n;
+}
+
+/**
+ * @brief Guarda una muestra codificada en la mitad que se está llenando
+ *
+ * Cuando el registro no cabe en el bloque abierto se abre otro; al agotarse
+ * los bloques la mitad se cierra para su envío y el muestreo sigue en la otra.
+ * Si la otra todavía no terminó de enviarse, la muestra se descarta (la
+ * siguiente guardada lleva el salto de tiempo).
+ * @param s Muestra a guardar
+ * @param timingUs Atraso del muestreo de la muestra
+ */
+void storeSample(const Sample &s, int32_t timingUs) {
+  if (halfFull[fillHalf]) {
+    droppedSamples++;
+    return;
+  }
+  uint8_t record[maxRecordBytes];
+  int used = halfBlocksUsed[fillHalf];
+  int n = used > 0 ? encodeSample(s, timingUs, record, false) : 0;
+
+  if (used == 0 || blockLength[fillHalf][used - 1] + n > blockBytes) {
+    if (used == halfBlocks) {
+      halfFull[fillHalf] = true;
+      fillHalf ^= 1;
+      if (halfFull[fillHalf]) {
+        droppedSamples++;
         return;
       }
+      used = 0;
     }
+    n = encodeSample(s, timingUs, record, true);
+    blockLength[fillHalf][used++] = 0;
+    halfBlocksUsed[fillHalf] = used;
+  }
 
-    // Aplicar nuevo valor PWM
-    analogWrite(enAPin, map(currentPWM, 0, 100, 0, 255));
+  memcpy(blocks[fillHalf][used - 1] + blockLength[fillHalf][used - 1], record, n);
+  blockLength[fillHalf][used - 1] += n;
+  lastStored = s;
+  storedSamples++;
+}
+
+/**
+ * @brief Posiciona un lector al principio de un bloque
+ */
+void startReader(BlockReader &r, const uint8_t *data, int length) {
+  r.data = data;
+  r.length = length;
+  r.offset = 0;
+  r.next.delta = 0;
+  r.next.pwm = 0;
+  r.next.rpm = 0;
+  r.timeSet = false;
+  r.timingPending = false;
+  r.hasTiming = false;
+}
+
+/**
+ * @brief Decodifica la próxima muestra de un bloque
+ * @param r Lector
+ * @param out Muestra decodificada
+ * @return false al llegar al final del bloque
+ */
+bool readSample(BlockReader &r, Sample &out) {
+  uint32_t v;
+  while (getVarint(r.data, r.length, r.offset, v)) {
+    if (v & 1) {
+      uint32_t arg = v >> 3;
+      switch ((v >> 1) & 3) {
+        case eventPwm:
+          r.next.pwm = arg;
+          break;
+        case eventGap:
+          r.next.delta += sampleInterval + arg;
+          r.timeSet = true;
+          break;
+        case eventTime:
+          r.next.delta = arg;
+          r.timeSet = true;
+          break;
+        case eventTiming:
+          r.timingUs = (int32_t)(arg >> 1) ^ -(int32_t)(arg & 1);
+          r.timingPending = true;
+          break;
+      }
+      continue;
+    }
+    if (!r.timeSet) {
+      r.next.delta += sampleInterval;
+    }
+    r.timeSet = false;
+    r.hasTiming = r.timingPending;
+    r.timingPending = false;
+    uint32_t change = v >> 1;
+    r.next.rpm += (int32_t)(change >> 1) ^ -(int32_t)(change & 1);
+    out = r.next;
+    return true;
   }
+  return false;
 }
 
 /**
- * @brief Procesa comandos recibidos por el puerto serial
- * @param cmd Comando recibido (String)
+ * @brief Reinicia el doble búfer y deja lista la cabecera de la exportación
  */
-void processCommand(String cmd) {
-  cmd.trim();
-  cmd.toUpperCase();
+void beginStream() {
+  halfBlocksUsed[0] = halfBlocksUsed[1] = 0;
+  halfFull[0] = halfFull[1] = false;
+  fillHalf = drainHalf = drainBlock = 0;
+  startReader(reader, blocks[0][0], 0);
+  storedSamples = 0;
+  droppedSamples = 0;
+  countedOverflows = captureOverflows;
+  endQueued = false;
+  txPos = 0;
 
-  if (cmd.startsWith("START")) {
-    // Iniciar secuencia de prueba automática
-    int spaceIndex = cmd.indexOf(' ');
-    if (spaceIndex != -1) {
-      pwmStep = cmd.substring(spaceIndex + 1).toInt();
-      pwmStep = constrain(pwmStep, 1, 100);
-      bufferIndex = 0;
-      currentPWM = 0;
-      descending = false;
-      analogWrite(enAPin, 0);
-      startTime = millis();
-      lastStepTime = millis();
-      currentState = CAPTURING;
-      Serial.println("📊 Iniciando captura de datos...");
-    }
-  } else if (cmd.startsWith("PWM")) {
-    // Configurar PWM manualmente
-    int spaceIndex = cmd.indexOf(' ');
-    if (spaceIndex != -1) {
-      int pwmVal = cmd.substring(spaceIndex + 1).toInt();
-      pwmVal = constrain(pwmVal, 0, 100);
-      currentPWM = pwmVal;
-      analogWrite(enAPin, map(pwmVal, 0, 100, 0, 255));
-      currentState = MANUAL_PWM;
-      Serial.println("🕹️ Modo manual activado");
+  if (binaryExport) {
+    uint8_t *payload = txBuffer + frameHeaderBytes;
+    frameSeq = 0;
+    memset(payload, 0, framePayloadBytes);
+    putU16(payload + 4, sampleInterval);
+    payload[6] = pwmStep;
+    payload[7] = frameVersion;
+    queueFrame(frameStart, 0);
+  } else {
+    txLength = snprintf((char *)txBuffer, sizeof(txBuffer), logJitter ? "delta;pwm;rpm;error_us\r\n" : "delta;pwm;rpm\r\n");
+  }
+}
+
+/**
+ * @brief Termina la captura: cierra la mitad parcial y pasa a terminar el envío
+ */
+void endCapture() {
+  if (halfBlocksUsed[fillHalf] > 0 && !halfFull[fillHalf]) {
+    halfFull[fillHalf] = true;
+  }
+  currentState = SENDING;
+}
+
+/**
+ * @brief Avanza la exportación sin bloquear el muestreo
+ *
+ * Escribe solo lo que cabe en el búfer de transmisión del puerto
+ * (availableForWrite()); cuando txBuffer se vacía lo vuelve a llenar con el
+ * siguiente paquete (o las siguientes líneas CSV) de la mitad a enviar. Al
+ * terminar la captura, y ya enviadas las dos mitades, agrega el cierre y
+ * vuelve a IDLE.
+ */
+void serviceStream() {
+  // Las respuestas salen entre paquetes (o líneas) para no partirlos
+  if ((txPos == 0 || txPos >= txLength) && flushReplies()) {
+    return;
+  }
+  if (txPos < txLength) {
+    int room = Serial.availableForWrite();
+    if (room <= 0) {
+      return;
     }
+    int n = min(room, txLength - txPos);
+    Serial.write(txBuffer + txPos, n);
+    txPos += n;
+    if (txPos < txLength) {
+      return;
+    }
+  }
+
+  txPos = txLength = 0;
+  if (halfFull[drainHalf]) {
+    encodeBlock();
+  } else if (currentState == SENDING && !endQueued) {
+    queueEnd();
+    endQueued = true;
+  } else if (currentState == SENDING) {
+    currentState = IDLE;
   }
 }
 
 /**
- * @brief Envía los datos capturados en formato CSV
- * 
- * Los datos se envían por el puerto serial con el formato:
- * tiempo_ms;PWM;RPM
- */
-void sendCSV() {
-  Serial.println("delta;pwm;rpm");
-  for (int i = 0; i < bufferIndex; i++) {
-    Serial.print(buffer[i].delta);
-    Serial.print(";");
-    Serial.print(buffer[i].pwm);
-    Serial.print(";");
-    Serial.println(buffer[i].rpm);
-  }
-  Serial.println("✅ Datos enviados correctamente");
-  currentState = IDLE;
-}
\ No newline at end of file
+ * @brief Pasa a txBuffer lo siguiente de la mitad a enviar
+ *
+ * En binario, el bloque compacto completo como carga de un paquete; en CSV,
+ * las muestras decodificadas, tantas líneas como quepan. La mitad se libera
+ * cuando se envió su último bloque.
+ */
+void encodeBlock() {
+  bool blockDone = true;
+
+  if (binaryExport) {
+    uint8_t *payload = txBuffer + frameHeaderBytes;
+    int length = blockLength[drainHalf][drainBlock];
+    memcpy(payload, blocks[drainHalf][drainBlock], length);
+    memset(payload + length, 0, framePayloadBytes - length);
+    queueFrame(frameData, length);
+  } else {
+    if (reader.data != blocks[drainHalf][drainBlock] || reader.length == 0) {
+      startReader(reader, blocks[drainHalf][drainBlock], blockLength[drainHalf][drainBlock]);
+    }
+    Sample s;
+    while (txLength + csvLineBytes <= (int)sizeof(txBuffer)) {
+      if (!readSample(reader, s)) {
+        break;
+      }
+      if (reader.hasTiming) {
+        txLength += snprintf((char *)txBuffer + txLength, csvLineBytes, "%lu;%u;%u;%ld\r\n",
+                             (unsigned long)s.delta, (unsigned)s.pwm, (unsigned)s.rpm, (long)reader.timingUs);
+      } else {
+        txLength += snprintf((char *)txBuffer + txLength, csvLineBytes, "%lu;%u;%u\r\n",
+                             (unsigned long)s.delta, (unsigned)s.pwm, (unsigned)s.rpm);
+      }
+    }
+    blockDone = reader.offset >= reader.length;
+    if (blockDone) {
+      reader.length = 0;
+    }
+  }
+
+  if (blockDone && ++drainBlock == halfBlocksUsed[drainHalf]) {
+    halfBlocksUsed[drainHalf] = 0;
+    halfFull[drainHalf] = false;
+    drainBlock = 0;
+    drainHalf ^= 1;
+  }
+}
+
+/**
+ * @brief Deja en txBuffer el cierre de la exportación
+ *
+ * En binario, el paquete de fin con los totales y el atraso del muestreo;
+ * en CSV, el atraso del muestreo y el mensaje final (con el aviso de muestras
+ * descartadas si las hubo).
+ */
+void queueEnd() {
+  countCaptureOverflows();
+  if (binaryExport) {
+    uint8_t *payload = txBuffer + frameHeaderBytes;
+    memset(payload, 0, framePayloadBytes);
+    putU32(payload, storedSamples);
+    putU16(payload + 4, frameSeq - 1);
+    putU32(payload + 6, droppedSamples);
+    putU32(payload + 10, jitterMaxUs);
+    putU32(payload + 14, jitterOverPeriod);
+    queueFrame(frameEnd, 0);
+    return;
+  }
+
+  txLength = snprintf((char *)txBuffer, sizeof(txBuffer),
+                      "⏱️ Atraso máximo del muestreo: %ld us | muestras con atraso de un período del encoder: %lu\r\n",
+                      (long)jitterMaxUs, (unsigned long)jitterOverPeriod);
+  if (droppedSamples > 0) {
+    txLength += snprintf((char *)txBuffer + txLength, sizeof(txBuffer) - txLength,
+                         "⚠️ %lu muestras descartadas: enlace lento o cola del muestreo llena\r\n", (unsigned long)droppedSamples);
+  } else {
+    txLength += snprintf((char *)txBuffer + txLength, sizeof(txBuffer) - txLength,
+                         "✅ Datos enviados correctamente\r\n");
+  }
+}
+
+/**
+ * @brief Actualiza un CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+ * @param crc CRC acumulado
+ * @param data Bytes a agregar
+ * @param len Cantidad de bytes
+ * @return CRC actualizado
+ */
+uint16_t crc16Update(uint16_t crc, const uint8_t *data, int len) {
+  for (int i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Escribe un entero de 16 bits en little-endian
+ */
+void putU16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+/**
+ * @brief Escribe un entero de 32 bits en little-endian
+ */
+void putU32(uint8_t *p, uint32_t v) {
+  putU16(p, v & 0xFFFF);
+  putU16(p + 2, v >> 16);
+}
+
+/**
+ * @brief Completa el paquete de txBuffer (con la carga ya escrita) y lo deja listo para enviar
+ * @param type Tipo de paquete
+ * @param length Bytes válidos de la carga (blockLength en datos, 0 en inicio y fin)
+ */
+void queueFrame(uint8_t type, uint8_t length) {
+  txBuffer[0] = frameMagic[0];
+  txBuffer[1] = frameMagic[1];
+  txBuffer[2] = type;
+  putU16(txBuffer + 3, frameSeq++);
+  txBuffer[5] = length;
+  uint16_t crc = crc16Update(0xFFFF, txBuffer + 2, frameBytes - 4);
+  putU16(txBuffer + frameBytes - 2, crc);
+  txLength = frameBytes;
+  txPos = 0;
+}
@@ -0,0 +1,114 @@
+"""
+@file comandos_binarios.py
+@brief Envía los comandos binarios de Completo.ino y decodifica sus acuses
+
+Comando (6 bytes, little-endian):  A5 | código | argumento (2) | CRC-16 (2)
+Acuse (10 bytes):                  5A A5 | código | resultado | estado | pwm | rpm (2) | CRC-16 (2)
+El CRC-16/CCITT-FALSE cubre desde el código hasta antes del CRC. El acuse
+puede llegar mezclado con la exportación de una captura en curso: se busca
+por su marca y se verifica el CRC.
+
+Uso:
+  python comandos_binarios.py --puerto COM3 START 20
+  python comandos_binarios.py --puerto COM3 STATUS
+Sale con código 1 si no llega el acuse o el comando no se ejecutó.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+from decodificar_binario import crc16_ccitt
+
+## @var COMMAND_MAGIC
+# @brief Primer byte de un comando
+COMMAND_MAGIC = 0xA5
+
+## @var ACK_MAGIC
+# @brief Marca de un acuse
+ACK_MAGIC = b"\x5A\xA5"
+
+## @var ACK_BYTES
+# @brief Tamaño de un acuse
+ACK_BYTES = 10
+
+## @var COMMANDS
+# @brief Códigos de comando por nombre
+COMMANDS = {"START": 1, "PWM": 2, "STOP": 3, "STATUS": 4}
+
+## @var RESULTS
+# @brief Nombres de los resultados del acuse
+RESULTS = {0: "ok", 1: "ocupado", 2: "CRC incorrecto", 3: "desconocido"}
+
+## @var STATES
+# @brief Nombres de los estados del sketch
+STATES = {0: "REPOSO", 1: "MANUAL", 2: "CAPTURANDO", 3: "ENVIANDO"}
+
+
+def encode_command(code, arg=0):
+    """
+    @brief Arma un comando binario.
+    @param code Código (COMMANDS).
+    @param arg Argumento de 16 bits.
+    @return Los 6 bytes del comando.
+    """
+    body = struct.pack("<BH", code, arg)
+    return bytes([COMMAND_MAGIC]) + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def find_acks(data):
+    """
+    @brief Busca acuses válidos en bytes recibidos.
+    @param data Bytes recibidos (pueden incluir texto y paquetes de datos).
+    @return Lista de diccionarios con código, resultado, estado, pwm y rpm.
+    """
+    acks = []
+    pos = data.find(ACK_MAGIC)
+    while 0 <= pos <= len(data) - ACK_BYTES:
+        ack = data[pos:pos + ACK_BYTES]
+        (crc,) = struct.unpack_from("<H", ack, ACK_BYTES - 2)
+        if crc16_ccitt(ack[2:ACK_BYTES - 2]) == crc:
+            code, result, state, pwm, rpm = struct.unpack_from("<BBBBH", ack, 2)
+            acks.append({"codigo": code, "resultado": result, "estado": state, "pwm": pwm, "rpm": rpm})
+            pos += ACK_BYTES
+        else:
+            pos += 1
+        pos = data.find(ACK_MAGIC, pos)
+    return acks
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Comandos binarios de Completo.ino")
+    parser.add_argument("--puerto", required=True, help="Puerto serial del sketch")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--espera", type=float, default=1.0, help="Segundos a esperar el acuse")
+    parser.add_argument("comando", choices=sorted(COMMANDS))
+    parser.add_argument("argumento", type=int, nargs="?", default=0)
+    args = parser.parse_args()
+
+    import serial
+
+    code = COMMANDS[args.comando]
+    with serial.Serial(args.puerto, args.baudios, timeout=0.05) as ser:
+        ser.reset_input_buffer()
+        sent = time.monotonic()
+        ser.write(encode_command(code, args.argumento))
+        received = bytearray()
+        ack = None
+        while ack is None and time.monotonic() - sent < args.espera:
+            received += ser.read(4096)
+            ack = next((a for a in find_acks(bytes(received)) if a["codigo"] == code), None)
+        elapsed_ms = (time.monotonic() - sent) * 1000
+
+    if ack is None:
+        print("❌ Sin acuse", file=sys.stderr)
+        return 1
+    print(f"{args.comando}: {RESULTS.get(ack['resultado'], ack['resultado'])} | "
+          f"estado: {STATES.get(ack['estado'], ack['estado'])} | PWM: {ack['pwm']}% | "
+          f"RPM: {ack['rpm']} | {elapsed_ms:.1f} ms")
+    return 0 if ack["resultado"] == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
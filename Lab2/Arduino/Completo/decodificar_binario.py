@@ -0,0 +1,323 @@
+"""
+@file decodificar_binario.py
+@brief Decodifica la exportación binaria de Completo.ino al CSV delta;pwm;rpm
+
+Lee los bytes crudos del puerto serial (o de un archivo con la captura ya
+guardada), busca los paquetes de tamaño fijo, verifica su CRC y su número de
+secuencia y escribe el mismo CSV que la exportación CSV del sketch. Los bytes
+que no forman un paquete válido (mensajes de texto del sketch, ruido) se saltan.
+
+Formato del paquete (little-endian, 232 bytes):
+  A5 5A | tipo (1) | secuencia (2) | cantidad (1) | carga (224) | CRC-16 (2)
+tipo 1 = inicio, 2 = datos, 3 = fin. La carga de datos depende de la versión
+del paquete de inicio (las anteriores a la 3 no se decodifican):
+  - 3: 'cantidad' bytes de un bloque de la codificación compacta de
+    Completo.ino (registros varint: muestras con el cambio de RPM en zigzag y
+    eventos de PWM y de tiempo; ver decode_block()).
+  - 4: igual que la 3, con el evento de atraso del muestreo por muestra (el
+    CSV agrega la columna error_us) y el atraso máximo en el paquete de fin.
+El sketch envía mientras captura, así que el total de muestras llega en el
+paquete de fin, junto con las muestras que descartó por enlace lento o por
+tener llena la cola del muestreo.
+
+Uso:
+  python decodificar_binario.py --puerto COM3 --salida datos.csv --comando "START 20"
+  python decodificar_binario.py --archivo captura.bin --salida datos.csv
+Sale con código 1 si la captura está incompleta, tiene paquetes corruptos, es de
+una versión que no se decodifica o el sketch descartó muestras.
+"""
+
+import argparse
+import struct
+import sys
+
+## @var MAGIC
+# @brief Marca de comienzo de paquete
+MAGIC = b"\xA5\x5A"
+
+## @var FRAME_START
+# @brief Tipo del paquete de inicio
+FRAME_START = 1
+
+## @var FRAME_DATA
+# @brief Tipo de los paquetes de datos
+FRAME_DATA = 2
+
+## @var FRAME_END
+# @brief Tipo del paquete de fin
+FRAME_END = 3
+
+## @var PAYLOAD_BYTES
+# @brief Carga de un paquete (blockBytes del sketch)
+PAYLOAD_BYTES = 224
+
+## @var FRAME_BYTES
+# @brief Tamaño total de un paquete
+FRAME_BYTES = 6 + PAYLOAD_BYTES + 2
+
+## @var MIN_VERSION
+# @brief Versión más antigua que se decodifica (la primera con carga compacta)
+MIN_VERSION = 3
+
+## @var EVENT_PWM
+# @brief Evento compacto: PWM de las muestras siguientes
+EVENT_PWM = 0
+
+## @var EVENT_GAP
+# @brief Evento compacto: la próxima muestra llega intervalo + arg ms después
+EVENT_GAP = 1
+
+## @var EVENT_TIME
+# @brief Evento compacto: tiempo absoluto de la próxima muestra
+EVENT_TIME = 2
+
+## @var EVENT_TIMING
+# @brief Evento compacto: atraso del muestreo de la próxima muestra en us (zigzag)
+EVENT_TIMING = 3
+
+## @var TIMING_VERSION
+# @brief Primera versión con el atraso del muestreo en el paquete de fin
+TIMING_VERSION = 4
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """
+    @brief CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF), el mismo del sketch.
+    @param data Bytes a verificar.
+    @param crc Valor inicial.
+    @return CRC de 16 bits.
+    """
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decode_block(block, interval):
+    """
+    @brief Decodifica un bloque compacto, igual que readSample() en el sketch.
+    @param block Bytes válidos del bloque.
+    @param interval Intervalo de muestreo en ms (del paquete de inicio).
+    @return Lista de muestras (delta, pwm, rpm), o (delta, pwm, rpm, error_us) si traen su atraso.
+    @throws ValueError si el bloque termina en medio de un varint.
+    """
+    samples = []
+    delta, pwm, rpm = 0, 0, 0
+    time_set = False
+    timing = None
+    pos = 0
+    while pos < len(block):
+        value, shift = 0, 0
+        while True:
+            if pos >= len(block) or shift > 28:
+                raise ValueError("varint cortado")
+            byte = block[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        if value & 1:
+            kind, arg = (value >> 1) & 3, value >> 3
+            if kind == EVENT_PWM:
+                pwm = arg
+            elif kind == EVENT_GAP:
+                delta += interval + arg
+                time_set = True
+            elif kind == EVENT_TIME:
+                delta = arg
+                time_set = True
+            elif kind == EVENT_TIMING:
+                timing = (arg >> 1) ^ -(arg & 1)
+            continue
+        if not time_set:
+            delta += interval
+        time_set = False
+        zigzag = value >> 1
+        rpm = (rpm + ((zigzag >> 1) ^ -(zigzag & 1))) & 0xFFFF
+        if timing is None:
+            samples.append((delta & 0xFFFFFFFF, pwm, rpm))
+        else:
+            samples.append((delta & 0xFFFFFFFF, pwm, rpm, timing))
+            timing = None
+    return samples
+
+
+class Decoder:
+    """
+    @brief Reconstruye la captura a partir de bytes que pueden llegar en pedazos.
+    """
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.reset_capture()
+
+    def reset_capture(self):
+        """
+        @brief Olvida la captura en curso (sin tocar los bytes pendientes).
+        """
+        self.samples = []
+        self.expected_total = None
+        self.expected_frames = None
+        self.interval = 0
+        self.version = 0
+        self.next_seq = 0
+        self.corrupt = 0
+        self.missing = 0
+        self.dropped = 0
+        self.jitter_max_us = None
+        self.jitter_over_period = None
+        self.unsupported = None
+        self.done = False
+
+    def feed(self, data):
+        """
+        @brief Agrega bytes y procesa todos los paquetes completos.
+        @param data Bytes recibidos.
+        """
+        self.pending += data
+        while not self.done:
+            start = self.pending.find(MAGIC)
+            if start < 0:
+                # Conserva un posible primer byte de la marca partida
+                del self.pending[:max(0, len(self.pending) - 1)]
+                return
+            del self.pending[:start]
+            if len(self.pending) < FRAME_BYTES:
+                return
+            frame = bytes(self.pending[:FRAME_BYTES])
+            (crc,) = struct.unpack_from("<H", frame, FRAME_BYTES - 2)
+            if crc16_ccitt(frame[2:FRAME_BYTES - 2]) != crc:
+                # Paquete dañado o marca falsa dentro de otros bytes: seguir buscando
+                self.corrupt += 1
+                del self.pending[:1]
+                continue
+            del self.pending[:FRAME_BYTES]
+            self.handle(frame)
+
+    def handle(self, frame):
+        """
+        @brief Procesa un paquete con CRC válido.
+        @param frame Paquete completo.
+        """
+        ftype, seq, count = struct.unpack_from("<BHB", frame, 2)
+        payload = frame[6:6 + PAYLOAD_BYTES]
+
+        if ftype == FRAME_START:
+            # Una captura nueva reemplaza a la anterior; el total (0 al transmitir
+            # mientras se captura) se confirma con el paquete de fin
+            total, interval, _step, version = struct.unpack_from("<IHBB", payload)
+            self.reset_capture()
+            if version < MIN_VERSION:
+                # Sin expected_total, los paquetes siguientes de esta captura se ignoran
+                self.unsupported = version
+                return
+            self.expected_total = total
+            self.interval = interval
+            self.version = version
+            self.next_seq = 1
+            return
+
+        if self.expected_total is None:
+            return  # Paquetes de una captura cuyo inicio no se vio
+        if seq != self.next_seq:
+            self.missing += (seq - self.next_seq) & 0xFFFF
+        self.next_seq = (seq + 1) & 0xFFFF
+
+        if ftype == FRAME_DATA:
+            self.samples.extend(decode_block(payload[:count], self.interval))
+        elif ftype == FRAME_END:
+            total, frames, dropped = struct.unpack_from("<IHI", payload)
+            self.expected_frames = frames
+            self.expected_total = total
+            self.dropped = dropped
+            if self.version >= TIMING_VERSION:
+                self.jitter_max_us, self.jitter_over_period = struct.unpack_from("<iI", payload, 10)
+            self.done = True
+
+    def ok(self):
+        """
+        @brief Indica si la captura llegó completa y sin errores.
+        @return True si está completa.
+        """
+        # Un paquete dañado se descarta y aparece como secuencia perdida; los CRC
+        # fallidos solos pueden ser marcas falsas en bytes que no son paquetes
+        return (self.done and self.missing == 0 and self.dropped == 0
+                and len(self.samples) == self.expected_total)
+
+    def write_csv(self, out):
+        """
+        @brief Escribe el CSV con el mismo formato que la exportación CSV del sketch (fin de línea CRLF).
+        @param out Archivo de texto abierto con newline="" (sin traducir los fines de línea).
+        """
+        if any(len(s) == 4 for s in self.samples):
+            out.write("delta;pwm;rpm;error_us\r\n")
+        else:
+            out.write("delta;pwm;rpm\r\n")
+        for sample in self.samples:
+            out.write(";".join(str(v) for v in sample) + "\r\n")
+
+
+def read_port(decoder, port, baud, command, timeout):
+    """
+    @brief Lee del puerto serial hasta el paquete de fin o hasta que pase @p timeout sin datos.
+    """
+    import serial
+
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        if command:
+            ser.write((command + "\n").encode("ascii"))
+        while not decoder.done:
+            chunk = ser.read(4096)
+            if not chunk:
+                break
+            decoder.feed(chunk)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodificador de la exportación binaria de Completo.ino")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--puerto", help="Puerto serial del sketch")
+    source.add_argument("--archivo", help="Archivo con los bytes crudos")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--comando", help='Comando a enviar antes de leer, por ejemplo "START 20"')
+    parser.add_argument("--espera", type=float, default=30.0, help="Segundos sin datos antes de abandonar")
+    parser.add_argument("--salida", default="-", help="CSV de salida (por defecto, la salida estándar)")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    if args.puerto:
+        read_port(decoder, args.puerto, args.baudios, args.comando, args.espera)
+    else:
+        with open(args.archivo, "rb") as f:
+            decoder.feed(f.read())
+
+    if args.salida == "-":
+        sys.stdout.reconfigure(newline="")
+        decoder.write_csv(sys.stdout)
+    else:
+        with open(args.salida, "w", newline="") as f:
+            decoder.write_csv(f)
+
+    print(f"Muestras: {len(decoder.samples)} de {decoder.expected_total} | "
+          f"CRC fallidos: {decoder.corrupt} | paquetes perdidos: {decoder.missing} | "
+          f"descartadas en el equipo: {decoder.dropped} | "
+          f"fin recibido: {'sí' if decoder.done else 'no'}", file=sys.stderr)
+    if decoder.unsupported is not None:
+        print(f"❌ Versión {decoder.unsupported} del formato no soportada (mínimo {MIN_VERSION}): "
+              f"actualizar Completo.ino", file=sys.stderr)
+        return 1
+    if not decoder.ok():
+        print("❌ Captura incompleta o con errores: repetir la prueba con START", file=sys.stderr)
+        return 1
+    if decoder.jitter_max_us is not None:
+        print(f"Atraso máximo del muestreo: {decoder.jitter_max_us} us | "
+              f"muestras con atraso de un período del encoder: {decoder.jitter_over_period}", file=sys.stderr)
+    print("✅ Captura completa", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
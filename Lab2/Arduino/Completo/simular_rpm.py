@@ -0,0 +1,266 @@
+"""
+@file simular_rpm.py
+@brief Compara la medición de RPM por conteo en la ventana con el método M/T de Completo.ino
+
+Genera trenes de pulsos sintéticos del encoder (20 pulsos por vuelta, con
+irregularidad de las ranuras), los muestrea cada 4 ms como el sketch (con un
+pequeño atraso variable del bucle) y aplica a cada ventana:
+  - conteo (sketch): pulsos * 60 / pulsos por vuelta, la fórmula original,
+    que no divide por el largo de la ventana;
+  - conteo escalado: pulsos * 60e6 / (pulsos por vuelta * ventana en us), lo
+    mejor que da el conteo a 250 Hz (un pulso de más son 750 RPM);
+  - M/T: measureRpmMT(), con los flancos marcados en us como micros().
+Además repite el M/T con rebotes: cada flanco real trae con cierta
+probabilidad uno o más flancos falsos pocos us después, con y sin el filtro
+de countPulse() (ignora flancos a menos de minEdgePeriodUs del anterior).
+El error se mide contra la velocidad real en el momento de cada muestra.
+
+Uso:
+  python simular_rpm.py [--ppr 20] [--irregularidad 0.02] [--rebotes 0.2] [--semilla 1]
+Sale con código 1 si en algún perfil el error del M/T no es menor que el del
+conteo escalado, o si con rebotes y filtro el error del M/T crece más de un 5 %.
+"""
+
+import argparse
+import math
+import random
+import sys
+
+## @var SAMPLE_US
+# @brief Intervalo de muestreo del sketch (sampleInterval)
+SAMPLE_US = 4000
+
+## @var STALL_TIMEOUT_US
+# @brief Sin flancos por este tiempo el motor se da por detenido (stallTimeoutUs)
+STALL_TIMEOUT_US = 500000
+
+## @var MIN_EDGE_PERIOD_US
+# @brief Período mínimo creíble entre flancos; más cerca es un rebote (minEdgePeriodUs)
+MIN_EDGE_PERIOD_US = 150
+
+## @var BOUNCE_MAX_US
+# @brief Mayor distancia de un rebote al flanco real
+BOUNCE_MAX_US = 100.0
+
+## @var STEP_US
+# @brief Paso de integración del perfil de velocidad
+STEP_US = 50.0
+
+
+def constant(rpm):
+    """@brief Perfil de velocidad constante."""
+    return lambda t: rpm
+
+
+def steps(levels, step_us, tau_us):
+    """
+    @brief Perfil de la prueba automática: escalones con respuesta de primer orden.
+    @param levels RPM finales de cada escalón.
+    @param step_us Duración de cada escalón (stepInterval).
+    @param tau_us Constante de tiempo del motor.
+    """
+    def profile(t):
+        i = min(int(t // step_us), len(levels) - 1)
+        start = levels[i - 1] if i > 0 else 0.0
+        return levels[i] + (start - levels[i]) * math.exp(-(t - i * step_us) / tau_us)
+    return profile
+
+
+## @var PROFILES
+# @brief Perfiles simulados: nombre, función de velocidad (RPM en función de us) y duración en us
+PROFILES = [
+    ("constante 30", constant(30.0), 4e6),
+    ("constante 100", constant(100.0), 4e6),
+    ("constante 300", constant(300.0), 2e6),
+    ("constante 1000", constant(1000.0), 2e6),
+    ("constante 3000", constant(3000.0), 2e6),
+    ("constante 6000", constant(6000.0), 2e6),
+    ("escalones 0-3000", steps([600, 1200, 1800, 2400, 3000, 2400, 1800, 1200, 600, 0], 2e6, 150e3), 20e6),
+]
+
+
+def edge_times(profile, duration_us, ppr, irregularity, rng):
+    """
+    @brief Momentos de los flancos de subida del encoder.
+    @param profile Velocidad en RPM en función del tiempo en us.
+    @param duration_us Duración del tren.
+    @param ppr Pulsos por vuelta.
+    @param irregularity Desvío relativo de la posición de cada ranura.
+    @param rng Generador aleatorio.
+    @return Lista ordenada de momentos en us (float).
+    """
+    # Error fijo de cada ranura: se repite en cada vuelta, como en un disco real
+    slots = [rng.gauss(0.0, irregularity) for _ in range(ppr)]
+    edges = []
+    phase = rng.random()  # Posición en pulsos
+    t = 0.0
+    while t < duration_us:
+        rate = profile(t) * ppr / 60e6  # Pulsos por us
+        end = phase + rate * STEP_US
+        k = math.floor(phase) + 1
+        while k <= end:
+            edge = t + (k - phase) / rate
+            edge += slots[k % ppr] / rate  # Corrimiento de la ranura (una fracción de período)
+            edges.append(edge)
+            k += 1
+        phase = end
+        t += STEP_US
+    edges.sort()
+    return edges
+
+
+def add_bounces(edges, probability, rng):
+    """
+    @brief Agrega rebotes a un tren de flancos.
+    @param edges Flancos reales (ordenados).
+    @param probability Probabilidad de que un flanco rebote (1 a 3 flancos falsos).
+    @param rng Generador aleatorio.
+    @return Lista ordenada con los flancos reales y los falsos.
+    """
+    noisy = []
+    for edge in edges:
+        noisy.append(edge)
+        if rng.random() < probability:
+            for _ in range(rng.randint(1, 3)):
+                noisy.append(edge + rng.uniform(1.0, BOUNCE_MAX_US))
+    noisy.sort()
+    return noisy
+
+
+class EdgeCounter:
+    """
+    @brief Réplica de countPulse(): cuenta flancos y guarda el último, opcionalmente ignorando rebotes.
+    """
+
+    def __init__(self, edges, debounce):
+        self.edges = edges
+        self.debounce = debounce
+        self.i = 0
+        self.last_edge = 0
+
+    def window(self, now):
+        """
+        @brief Pulsos hasta @p now (lo que lee la alarma y pone en cero).
+        @return Pulsos de la ventana y momento del último flanco (us enteros, como micros()).
+        """
+        count = 0
+        while self.i < len(self.edges) and self.edges[self.i] <= now:
+            edge = int(self.edges[self.i])  # micros() trunca
+            self.i += 1
+            if self.debounce and ((edge - self.last_edge) & 0xFFFFFFFF) < MIN_EDGE_PERIOD_US:
+                continue
+            self.last_edge = edge
+            count += 1
+        return count, self.last_edge
+
+
+class MTEstimator:
+    """
+    @brief Réplica de measureRpmMT() del sketch.
+    """
+
+    def __init__(self, ppr):
+        self.ppr = ppr
+        self.ref_edge = 0
+        self.have_ref = False
+        self.rpm = 0.0
+
+    def update(self, count, edge_us, now_us):
+        """
+        @brief Estimación de una ventana.
+        @param count Pulsos de la ventana.
+        @param edge_us Momento del último flanco (us enteros).
+        @param now_us Momento de la muestra.
+        @return RPM estimadas.
+        """
+        if count > 0:
+            span = (edge_us - self.ref_edge) & 0xFFFFFFFF
+            if self.have_ref and span > 0:
+                self.rpm = count * 60e6 / (self.ppr * span)
+            self.ref_edge = edge_us
+            self.have_ref = True
+        elif self.have_ref:
+            since = (now_us - self.ref_edge) & 0xFFFFFFFF
+            if since >= STALL_TIMEOUT_US:
+                self.rpm = 0.0
+                self.have_ref = False
+            else:
+                self.rpm = min(self.rpm, 60e6 / (self.ppr * since))
+        return self.rpm
+
+
+def simulate(profile, duration_us, ppr, irregularity, bounces, rng):
+    """
+    @brief Muestrea un tren de pulsos con los tres métodos, y con el M/T sobre el tren con rebotes.
+    @return Diccionario método -> lista de errores absolutos en RPM, y la velocidad real media.
+    """
+    edges = edge_times(profile, duration_us, ppr, irregularity, rng)
+    noisy = add_bounces(edges, bounces, rng)
+    clean = EdgeCounter(edges, True)
+    streams = {"M/T": (clean, MTEstimator(ppr)),
+               "M/T con rebotes": (EdgeCounter(noisy, True), MTEstimator(ppr)),
+               "M/T con rebotes sin filtro": (EdgeCounter(noisy, False), MTEstimator(ppr))}
+    errors = {"conteo (sketch)": [], "conteo escalado": []}
+    errors.update({name: [] for name in streams})
+    truth = []
+    last_sample = 0
+    sample = SAMPLE_US
+    while sample < duration_us:
+        # El bucle del sketch atiende la muestra con algo de atraso
+        now = sample + rng.uniform(0.0, 300.0)
+        real = profile(now)
+        truth.append(real)
+        window = now - last_sample
+        last_sample = now
+        # Se descarta el primer segundo: el M/T necesita un flanco de referencia
+        measure = now > 1e6
+        for name, (counter, mt) in streams.items():
+            count, last_edge = counter.window(now)
+            rpm = mt.update(count, last_edge, int(now))
+            if measure:
+                errors[name].append(abs(rpm - real))
+            if counter is clean and measure:
+                errors["conteo (sketch)"].append(abs(count * 60.0 / ppr - real))
+                errors["conteo escalado"].append(abs(count * 60e6 / (ppr * window) - real))
+        sample += SAMPLE_US
+    return errors, sum(truth) / len(truth)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Error de la medición de RPM: conteo contra M/T")
+    parser.add_argument("--ppr", type=int, default=20, help="Pulsos por vuelta del encoder")
+    parser.add_argument("--irregularidad", type=float, default=0.02,
+                        help="Desvío de la posición de las ranuras (fracción de período)")
+    parser.add_argument("--rebotes", type=float, default=0.2,
+                        help="Probabilidad de que un flanco rebote")
+    parser.add_argument("--semilla", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.semilla)
+    print("perfil;rpm_media;metodo;error_medio;error_rms;error_max")
+    ok = True
+    for name, profile, duration in PROFILES:
+        errors, mean_rpm = simulate(profile, duration, args.ppr, args.irregularidad, args.rebotes, rng)
+        for method, errs in errors.items():
+            mean = sum(errs) / len(errs)
+            rms = math.sqrt(sum(e * e for e in errs) / len(errs))
+            print(f"{name};{mean_rpm:.0f};{method};{mean:.1f};{rms:.1f};{max(errs):.1f}")
+        mt_rms = math.sqrt(sum(e * e for e in errors["M/T"]) / len(errors["M/T"]))
+        count_rms = math.sqrt(sum(e * e for e in errors["conteo escalado"]) / len(errors["conteo escalado"]))
+        bounce_rms = math.sqrt(sum(e * e for e in errors["M/T con rebotes"]) / len(errors["M/T con rebotes"]))
+        if mt_rms >= count_rms:
+            ok = False
+            print(f"❌ {name}: el M/T no mejora al conteo", file=sys.stderr)
+        if bounce_rms > mt_rms * 1.05 + 0.5:
+            ok = False
+            print(f"❌ {name}: los rebotes pasan el filtro ({bounce_rms:.1f} contra {mt_rms:.1f} RPM)", file=sys.stderr)
+
+    if not ok:
+        return 1
+    print("✅ El M/T tiene menos error que el conteo en todos los perfiles y el filtro absorbe los rebotes",
+          file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -28,6 +28,7 @@
 #include "include/adc_audio.h"
 #include "include/led_status.h"
 #include "include/eeprom.h"
+#include "include/uart_rx.h"
 
 /// UART y Pines GPS
 #define UART_ID uart1
@@ -35,6 +36,8 @@
 #define UART_TX_PIN 8
 #define UART_RX_PIN 9
 #define BUF_SIZE 256
+#define GPS_RX_BUFFER 1024  ///< Búfer circular del GPS (~1 s de datos a 9600 baudios)
+#define GPS_POLL_US 10000   ///< Período de publicación del DMA del GPS
 
 /// Pines de sincronización
 #define PPS_PIN 7
@@ -45,6 +48,10 @@ volatile bool gps_lock = false;              ///< Señal de sincronización GPS
 volatile bool boton_presionado = false;      ///< Bandera de botón físico presionado.
 volatile uint32_t last_boton_ms = 0;         ///< Último tiempo de presión de botón.
 
+/// Recepción del GPS por DMA (UART/src/uart_rx.c)
+static uart_rx_t gps_rx;
+static uint8_t gps_rx_buffer[GPS_RX_BUFFER] __attribute__((aligned(GPS_RX_BUFFER)));
+
 /// Máquina de estados principal
 typedef enum {
     ESTADO_INICIAL,
@@ -69,7 +76,8 @@ void gpio_global_callback(uint gpio, uint32_t events);
 /**
  * @brief Inicializa la UART para comunicación con el módulo GPS.
  *
- * Configura los pines TX y RX para UART y establece la velocidad de comunicación.
+ * Configura los pines TX y RX para UART, establece la velocidad de comunicación
+ * y arranca la recepción por DMA en un búfer circular.
  */
 void init_uart_gps();
 
@@ -122,6 +130,11 @@ void init_uart_gps() {
     uart_init(UART_ID, BAUD_RATE);
     gpio_set_function(UART_TX_PIN, GPIO_FUNC_UART);
     gpio_set_function(UART_RX_PIN, GPIO_FUNC_UART);
+    if (!uart_rx_init_dma(&gps_rx, UART_ID, gps_rx_buffer, sizeof(gps_rx_buffer), GPS_POLL_US)) {
+        // Sin canal DMA o alarma libre: la misma API, llenada por interrupción
+        uart_rx_init(&gps_rx, UART_ID, gps_rx_buffer, sizeof(gps_rx_buffer));
+        printf("⚠️ GPS sin DMA: recepción por interrupción\n");
+    }
 }
 
 void init_botones_pps() {
@@ -143,11 +156,15 @@ bool capturar_datos() {
     bool gps_valido = false;
 
     printf("\n📡 Esperando datos GPS válidos...\n");
+    // Descarta lo acumulado antes de la captura: solo sirven sentencias nuevas
+    while (uart_rx_getc(&gps_rx) >= 0) {
+    }
     uint64_t start = to_ms_since_boot(get_absolute_time());
 
     while (to_ms_since_boot(get_absolute_time()) - start < 5000) {
-        if (uart_is_readable(UART_ID)) {
-            char c = uart_getc(UART_ID);
+        int rc = uart_rx_getc(&gps_rx);
+        if (rc >= 0) {
+            char c = (char)rc;
             if (c == '\n' || index >= BUF_SIZE - 1) {
                 line[index] = '\0';
                 index = 0;
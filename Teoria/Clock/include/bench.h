@@ -0,0 +1,150 @@
+/**
+ * @file bench.h
+ * @brief Arnés de microbenchmarks para el PC y para la Raspberry Pi Pico.
+ *
+ * Mide una función llamándola en lotes: calibra el tamaño del lote hasta que
+ * dure bastante más que la resolución del reloj, la calienta, y toma muestras
+ * (tiempo por llamada) hasta que la mediana se estabiliza. Al tiempo de cada
+ * muestra se le resta el costo de una llamada vacía medido con el mismo
+ * bucle, así que solo queda el trabajo de la función.
+ *
+ * Relojes:
+ * - PC: CLOCK_MONOTONIC para nanosegundos; rdtsc (x86-64) o cntvct_el0
+ *   (AArch64) para ciclos. rdtsc cuenta a frecuencia fija, no a la del núcleo.
+ * - RP2040: el temporizador de 1 MHz (time_us_64) para nanosegundos y SysTick
+ *   (24 bits, a la frecuencia del procesador) para ciclos. El lote se limita
+ *   para que SysTick no dé más de una vuelta.
+ *
+ * El mismo código de benchmark compila en los dos lados; el backend se elige
+ * con PICO_ON_DEVICE, que el SDK de la Pico define al compilar para la placa.
+ *
+ * Para que el compilador no elimine el trabajo medido, la función debe pasar
+ * sus resultados por BENCH_KEEP() o bench_escape() (barreras vacías en asm
+ * que el optimizador no puede ver por dentro).
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef BENCH_MAX_SAMPLES
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#define BENCH_MAX_SAMPLES 256   ///< Muestras máximas por benchmark (RAM de la placa)
+#else
+#define BENCH_MAX_SAMPLES 2048  ///< Muestras máximas por benchmark
+#endif
+#endif
+
+/**
+ * @brief Obliga al compilador a calcular @p x (sin emitir instrucciones).
+ */
+#define BENCH_KEEP(x) __asm__ volatile("" : : "g"(x) : "memory")
+
+/**
+ * @brief Oculta al compilador el valor de la variable @p x (que sigue valiendo lo mismo).
+ *
+ * Evita que una constante (un factor de escala, un largo) se propague dentro
+ * de la función medida y la especialice.
+ */
+#define BENCH_LAUNDER(x) __asm__ volatile("" : "+r"(x))
+
+/**
+ * @brief Marca la memoria apuntada por @p p como leída por código desconocido.
+ * @param p Puntero a los datos que el compilador no debe descartar.
+ */
+static inline void bench_escape(const void *p) {
+    __asm__ volatile("" : : "g"(p) : "memory");
+}
+
+/**
+ * @brief Obliga al compilador a suponer que toda la memoria cambió.
+ */
+static inline void bench_clobber(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+/**
+ * @brief Función a medir; @p ctx son sus datos.
+ */
+typedef void (*bench_fn_t)(void *ctx);
+
+/**
+ * @struct bench_config_t
+ * @brief Parámetros de una medición (ver bench_default_config()).
+ */
+typedef struct {
+    uint32_t warmup_ms;     /**< Calentamiento antes de tomar muestras. */
+    uint32_t batch_us;      /**< Duración mínima de un lote. */
+    uint32_t max_ms;        /**< Tiempo máximo de muestreo. */
+    int min_samples;        /**< Muestras mínimas. */
+    int max_samples;        /**< Muestras máximas (<= BENCH_MAX_SAMPLES). */
+    double stable_rel;      /**< Cambio relativo de la mediana que se considera estable. */
+} bench_config_t;
+
+/**
+ * @struct bench_result_t
+ * @brief Estadísticas por llamada de un benchmark.
+ */
+typedef struct {
+    const char *name;       /**< Nombre del benchmark. */
+    uint32_t batch;         /**< Llamadas por lote. */
+    int samples;            /**< Lotes medidos. */
+    bool stable;            /**< La mediana se estabilizó antes de los límites. */
+    double min_ns;          /**< Mínimo en nanosegundos. */
+    double median_ns;       /**< Mediana en nanosegundos. */
+    double p99_ns;          /**< Percentil 99 en nanosegundos. */
+    double min_cycles;      /**< Mínimo en ciclos. */
+    double median_cycles;   /**< Mediana en ciclos. */
+    double p99_cycles;      /**< Percentil 99 en ciclos. */
+} bench_result_t;
+
+/**
+ * @brief Inicializa el reloj (y en la placa, stdio y SysTick). Llamar una vez al inicio.
+ */
+void bench_init(void);
+
+/**
+ * @brief Termina el programa de medición: usar como return bench_finish(código) en main().
+ *
+ * En el PC devuelve @p status. En la placa no vuelve: volver de main() llama a
+ * _exit(), que sin depurador termina en HardFault y puede perder las últimas
+ * filas que esperan salir por USB, así que se queda en un bucle.
+ * @param status Código de salida.
+ * @return @p status (solo en el PC).
+ */
+int bench_finish(int status);
+
+/**
+ * @brief Configuración por defecto del backend actual.
+ * @return Configuración.
+ */
+bench_config_t bench_default_config(void);
+
+/**
+ * @brief Mide @p fn y calcula sus estadísticas por llamada.
+ * @param name Nombre que aparecerá en el resultado.
+ * @param fn Función a medir.
+ * @param ctx Datos de la función.
+ * @param cfg Configuración (NULL: bench_default_config()).
+ * @param out Resultado.
+ */
+void bench_run(const char *name, bench_fn_t fn, void *ctx, const bench_config_t *cfg,
+               bench_result_t *out);
+
+/**
+ * @brief Escribe la fila de encabezado del CSV.
+ * @param f Flujo de salida.
+ */
+void bench_csv_header(FILE *f);
+
+/**
+ * @brief Escribe un resultado como fila CSV.
+ * @param f Flujo de salida.
+ * @param r Resultado.
+ */
+void bench_csv_row(FILE *f, const bench_result_t *r);
+
+#endif // BENCH_H
@@ -1,22 +1,64 @@
+/**
+ * @file main.c
+ * @brief Manejo del tiempo: medir una función con el arnés de src/bench.c.
+ *
+ * La versión original medía process() con clock(), pero con -O2 el compilador
+ * borra el bucle vacío y clock() solo cuenta ticks gruesos de tiempo de CPU.
+ * Aquí se mide el mismo bucle con y sin barrera contra la eliminación de
+ * código, y el propio costo de llamar a clock(), y se imprime un CSV con
+ * mínimo, mediana y p99 en nanosegundos y ciclos.
+ *
+ * Compilación (PC): gcc -O2 -I. main.c src/bench.c -o clock
+ * Compilación (Pico): cmake -S pico -B pico/build && cmake --build pico/build
+ */
+
 #include <stdio.h>
 #include <time.h>
+#include "include/bench.h"
+
+#define LOOP_ITERATIONS 1000000  ///< Iteraciones del bucle de la versión original
 
-void process()
-{
-    for(int i = 0; i < 1000000; i++)
-    {
+/**
+ * @brief Bucle original: sin efectos visibles, el optimizador lo elimina.
+ */
+static void process(void *ctx) {
+    (void)ctx;
+    for (int i = 0; i < LOOP_ITERATIONS; i++) {
         // Do something
     }
 }
 
-int main()
-{
-    clock_t start, stop;
-    start = clock();
-    process();
-    stop = clock();
-    printf("%ld\n", stop - start);
-    long tiempo = 1000000*(stop - start) / CLOCKS_PER_SEC; // Tiempo en microsegundos
-    printf("%ld\n", tiempo);
-    return 0;
-}
\ No newline at end of file
+/**
+ * @brief El mismo bucle con una barrera que obliga a ejecutar cada iteración.
+ */
+static void process_kept(void *ctx) {
+    (void)ctx;
+    for (int i = 0; i < LOOP_ITERATIONS; i++) {
+        BENCH_KEEP(i);
+    }
+}
+
+/**
+ * @brief Costo de leer el reloj que usaba la versión original.
+ */
+static void read_clock(void *ctx) {
+    (void)ctx;
+    clock_t now = clock();
+    BENCH_KEEP(now);
+}
+
+int main() {
+    bench_init();
+
+    bench_result_t r;
+    bench_csv_header(stdout);
+
+    bench_run("bucle_sin_barrera", process, NULL, NULL, &r);
+    bench_csv_row(stdout, &r);
+    bench_run("bucle_con_barrera", process_kept, NULL, NULL, &r);
+    bench_csv_row(stdout, &r);
+    bench_run("clock", read_clock, NULL, NULL, &r);
+    bench_csv_row(stdout, &r);
+
+    return bench_finish(0);
+}
@@ -0,0 +1,240 @@
+/**
+ * @file bench.c
+ * @brief Implementación del arnés de microbenchmarks.
+ */
+
+#include "include/bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#define SYSTICK_MASK 0x00FFFFFFu   ///< SysTick es un contador descendente de 24 bits
+#define SYSTICK_SAFE_US 50000u     ///< Lotes más largos podrían dar más de una vuelta a SysTick
+
+/// Nanosegundos actuales con el temporizador de 1 MHz
+static inline uint64_t clock_ns(void) {
+    return time_us_64() * 1000u;
+}
+
+/// Ciclos actuales (SysTick invertido para que crezca)
+static inline uint64_t clock_cycles(void) {
+    return SYSTICK_MASK - systick_hw->cvr;
+}
+
+/// Ciclos entre dos lecturas; @p ns se usa si el lote fue demasiado largo para SysTick
+static inline uint64_t cycles_between(uint64_t start, uint64_t end, uint64_t ns) {
+    if (ns > (uint64_t)SYSTICK_SAFE_US * 1000u) {
+        return ns * (clock_get_hz(clk_sys) / 1000000u) / 1000u;
+    }
+    return (end - start) & SYSTICK_MASK;
+}
+
+void bench_init(void) {
+    stdio_init_all();
+    sleep_ms(2000);  // Tiempo para abrir el monitor serial por USB
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // ENABLE | CLKSOURCE (reloj del procesador), sin interrupción
+}
+
+int bench_finish(int status) {
+    (void)status;
+    // Volver de main() llega a _exit(), que sin depurador cae en HardFault y corta el USB
+    fflush(stdout);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+bench_config_t bench_default_config(void) {
+    // Con 1 us de resolución, un lote de 1 ms deja el error de cuantización en 0,1 %
+    return (bench_config_t){.warmup_ms = 50, .batch_us = 1000, .max_ms = 2000,
+                            .min_samples = 32, .max_samples = BENCH_MAX_SAMPLES, .stable_rel = 0.005};
+}
+
+#else
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/// Nanosegundos actuales del reloj monotónico
+static inline uint64_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/// Ciclos actuales del contador de marca de tiempo
+static inline uint64_t clock_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return clock_ns();
+#endif
+}
+
+/// Ciclos entre dos lecturas
+static inline uint64_t cycles_between(uint64_t start, uint64_t end, uint64_t ns) {
+    (void)ns;
+    return end - start;
+}
+
+void bench_init(void) {
+}
+
+int bench_finish(int status) {
+    return status;
+}
+
+bench_config_t bench_default_config(void) {
+    return (bench_config_t){.warmup_ms = 100, .batch_us = 200, .max_ms = 1000,
+                            .min_samples = 64, .max_samples = BENCH_MAX_SAMPLES, .stable_rel = 0.002};
+}
+#endif
+
+#define BENCH_ROUND 16          ///< Muestras entre controles de estabilidad
+#define BENCH_MAX_BATCH (1u << 30) ///< Tope de llamadas por lote
+
+static double sample_ns[BENCH_MAX_SAMPLES];     ///< Tiempo por llamada de cada lote
+static double sample_cycles[BENCH_MAX_SAMPLES]; ///< Ciclos por llamada de cada lote
+static double sorted[BENCH_MAX_SAMPLES];        ///< Copia ordenada para las estadísticas
+
+static bool overhead_ready;         ///< Ya se midió la llamada vacía
+static double overhead_ns;          ///< Costo de una llamada vacía en nanosegundos
+static double overhead_cycles;      ///< Costo de una llamada vacía en ciclos
+
+/**
+ * @brief Función vacía usada para medir el costo del bucle y de la llamada.
+ */
+static void empty_call(void *ctx) {
+    bench_escape(ctx);
+}
+
+/**
+ * @brief Llama @p batch veces a @p fn y mide el lote.
+ */
+static void run_batch(bench_fn_t fn, void *ctx, uint32_t batch, uint64_t *ns, uint64_t *cycles) {
+    bench_clobber();
+    uint64_t t0 = clock_ns();
+    uint64_t c0 = clock_cycles();
+    for (uint32_t i = 0; i < batch; i++) {
+        fn(ctx);
+    }
+    uint64_t c1 = clock_cycles();
+    uint64_t t1 = clock_ns();
+    bench_clobber();
+    *ns = t1 - t0;
+    *cycles = cycles_between(c0, c1, *ns);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena una copia de las muestras y devuelve mínimo, mediana y p99.
+ */
+static void summarize(const double *samples, int count, double *min, double *median, double *p99) {
+    memcpy(sorted, samples, (size_t)count * sizeof(*sorted));
+    qsort(sorted, (size_t)count, sizeof(*sorted), compare_double);
+    *min = sorted[0];
+    *median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+    // Rango más cercano: la muestra ceil(0.99 * count)
+    int rank = (count * 99 + 99) / 100;
+    *p99 = sorted[rank - 1];
+}
+
+/**
+ * @brief Medición sin restar la llamada vacía (la usan bench_run() y la calibración).
+ */
+static void measure(const char *name, bench_fn_t fn, void *ctx, const bench_config_t *cfg,
+                    double sub_ns, double sub_cycles, bench_result_t *out) {
+    int max_samples = cfg->max_samples > 0 && cfg->max_samples <= BENCH_MAX_SAMPLES
+                          ? cfg->max_samples : BENCH_MAX_SAMPLES;
+    int min_samples = cfg->min_samples > 0 && cfg->min_samples <= max_samples ? cfg->min_samples : max_samples;
+    uint64_t target_ns = (uint64_t)cfg->batch_us * 1000u;
+    uint64_t ns, cycles;
+
+    // Calibración: duplicar el lote hasta que dure al menos batch_us
+    uint32_t batch = 1;
+    for (;;) {
+        run_batch(fn, ctx, batch, &ns, &cycles);
+        if (ns >= target_ns || batch >= BENCH_MAX_BATCH) break;
+        // Salto directo cuando el lote es mucho más corto que el objetivo
+        uint64_t grow = ns ? target_ns / ns : 0;
+        batch = grow >= 4 && (uint64_t)batch * grow < BENCH_MAX_BATCH ? batch * (uint32_t)grow : batch * 2;
+    }
+
+    // Calentamiento: cachés, predictores y frecuencia del procesador
+    uint64_t warm_end = clock_ns() + (uint64_t)cfg->warmup_ms * 1000000u;
+    while (clock_ns() < warm_end) {
+        run_batch(fn, ctx, batch, &ns, &cycles);
+    }
+
+    // Muestreo por rondas hasta que la mediana deje de moverse
+    uint64_t deadline = clock_ns() + (uint64_t)cfg->max_ms * 1000000u;
+    double previous = -1.0, min, median, p99;
+    int count = 0;
+    out->stable = false;
+    while (count < max_samples) {
+        for (int i = 0; i < BENCH_ROUND && count < max_samples; i++, count++) {
+            run_batch(fn, ctx, batch, &ns, &cycles);
+            double per_ns = (double)ns / batch - sub_ns;
+            double per_cycles = (double)cycles / batch - sub_cycles;
+            sample_ns[count] = per_ns > 0.0 ? per_ns : 0.0;
+            sample_cycles[count] = per_cycles > 0.0 ? per_cycles : 0.0;
+        }
+        if (count < min_samples) continue;
+
+        summarize(sample_ns, count, &min, &median, &p99);
+        double change = median - previous;
+        if (previous >= 0.0 && (change < 0.0 ? -change : change) <= cfg->stable_rel * previous) {
+            out->stable = true;
+            break;
+        }
+        previous = median;
+        if (clock_ns() >= deadline) break;
+    }
+
+    out->name = name;
+    out->batch = batch;
+    out->samples = count;
+    summarize(sample_ns, count, &out->min_ns, &out->median_ns, &out->p99_ns);
+    summarize(sample_cycles, count, &out->min_cycles, &out->median_cycles, &out->p99_cycles);
+}
+
+void bench_run(const char *name, bench_fn_t fn, void *ctx, const bench_config_t *cfg,
+               bench_result_t *out) {
+    bench_config_t defaults = bench_default_config();
+    if (!cfg) cfg = &defaults;
+
+    if (!overhead_ready) {
+        bench_result_t empty;
+        measure("vacio", empty_call, NULL, &defaults, 0.0, 0.0, &empty);
+        overhead_ns = empty.median_ns;
+        overhead_cycles = empty.median_cycles;
+        overhead_ready = true;
+    }
+    measure(name, fn, ctx, cfg, overhead_ns, overhead_cycles, out);
+}
+
+void bench_csv_header(FILE *f) {
+    fprintf(f, "nombre,lote,muestras,estable,min_ns,mediana_ns,p99_ns,min_ciclos,mediana_ciclos,p99_ciclos\n");
+}
+
+void bench_csv_row(FILE *f, const bench_result_t *r) {
+    fprintf(f, "%s,%lu,%d,%d,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f\n", r->name, (unsigned long)r->batch,
+            r->samples, r->stable ? 1 : 0, r->min_ns, r->median_ns, r->p99_ns,
+            r->min_cycles, r->median_cycles, r->p99_cycles);
+}
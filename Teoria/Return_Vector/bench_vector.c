@@ -0,0 +1,359 @@
+/**
+ * @file bench_vector.c
+ * @brief Compara cada núcleo de src/vector_kernels.c contra el bucle escalar simple.
+ *
+ * Primero verifica que cada núcleo dé exactamente lo mismo que su versión
+ * escalar (con datos aleatorios y con los extremos de int16), y después mide
+ * las dos con el arnés de Teoria/Clock. El CSV tiene una fila por núcleo e
+ * implementación: "vec_dot[avx2]" contra "vec_dot[referencia]" (el bucle
+ * escalar simple). Sin SIMD el núcleo compilado es "vec_dot[escalar]".
+ *
+ * Las versiones escalares son el estilo de scaled_vector original: sin
+ * restrict y, en GCC, sin vectorización automática.
+ *
+ * Compilación (PC): gcc -O3 -march=native -I. -I../Clock bench_vector.c src/vector_kernels.c
+ *                   ../Clock/src/bench.c -o bench_vector
+ * (con -msse4.1 o sin -march para comparar las otras implementaciones)
+ * Compilación (Pico): cmake -S pico -B pico/build && cmake --build pico/build
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/vector_kernels.h"
+#include "include/bench.h"
+
+#define BLOCK 1024  ///< Elementos por bloque (un bloque del ADC)
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define SCALAR __attribute__((noinline, optimize("no-tree-vectorize")))
+#else
+#define SCALAR __attribute__((noinline))
+#endif
+
+static int32_t in32[BLOCK];     ///< Entrada de 32 bits
+static int32_t out32[BLOCK];    ///< Salida de 32 bits
+static int16_t in16[BLOCK];     ///< Entrada de 16 bits
+static int16_t other16[BLOCK];  ///< Segunda entrada de 16 bits (producto punto)
+static int16_t out16[BLOCK];    ///< Salida de 16 bits
+static int32_t check32[BLOCK];  ///< Resultado escalar para verificar
+static int16_t check16[BLOCK];  ///< Resultado escalar para verificar
+
+#define OFFSET 2048     ///< Nivel de continua de un ADC de 12 bits
+#define SCALE 3         ///< Factor entero
+#define SCALE_Q15 24576 ///< 0.75 en Q15
+#define SHIFT 15        ///< Corrimiento de la escala Q15
+
+// ---------------------------------------------------------------------------
+// Versiones escalares de referencia
+// ---------------------------------------------------------------------------
+
+SCALAR static void scalar_scale(const int32_t *pin, size_t ion, int32_t scale, int32_t *pout) {
+    for (size_t i = 0; i < ion; i++) pout[i] = pin[i] * scale;
+}
+
+SCALAR static void scalar_scale_inplace(int32_t *v, size_t ion, int32_t scale) {
+    for (size_t i = 0; i < ion; i++) v[i] *= scale;
+}
+
+SCALAR static void scalar_offset_scale(const int32_t *pin, size_t ion, int32_t offset, int32_t scale,
+                                       int32_t *pout) {
+    for (size_t i = 0; i < ion; i++) pout[i] = (pin[i] - offset) * scale;
+}
+
+SCALAR static void scalar_offset_scale_inplace(int32_t *v, size_t ion, int32_t offset, int32_t scale) {
+    for (size_t i = 0; i < ion; i++) v[i] = (v[i] - offset) * scale;
+}
+
+SCALAR static void scalar_scale_sat16(const int16_t *pin, size_t ion, int16_t scale, int shift,
+                                      int16_t *pout) {
+    for (size_t i = 0; i < ion; i++) {
+        int32_t v = ((int32_t)pin[i] * scale) >> shift;
+        pout[i] = v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+    }
+}
+
+SCALAR static int64_t scalar_dot(const int16_t *a, const int16_t *b, size_t ion) {
+    int64_t acc = 0;
+    for (size_t i = 0; i < ion; i++) acc += (int32_t)a[i] * b[i];
+    return acc;
+}
+
+SCALAR static int64_t scalar_sum_squares(const int16_t *pin, size_t ion) {
+    int64_t acc = 0;
+    for (size_t i = 0; i < ion; i++) acc += (int32_t)pin[i] * pin[i];
+    return acc;
+}
+
+SCALAR static void scalar_minmax(const int32_t *pin, size_t ion, int32_t *min, int32_t *max) {
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (size_t i = 0; i < ion; i++) {
+        if (pin[i] < lo) lo = pin[i];
+        if (pin[i] > hi) hi = pin[i];
+    }
+    *min = lo;
+    *max = hi;
+}
+
+// ---------------------------------------------------------------------------
+// Verificación
+// ---------------------------------------------------------------------------
+
+static uint32_t rng_state = 12345u;  ///< Semilla del generador de datos
+
+/// Generador congruencial (el mismo resultado en el PC y en la placa)
+static uint32_t next_random(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+/**
+ * @brief Llena las entradas: aleatorias, o con los extremos de int16 si @p extremes.
+ */
+static void fill_inputs(bool extremes) {
+    for (int i = 0; i < BLOCK; i++) {
+        if (extremes) {
+            in16[i] = (i & 1) ? INT16_MAX : INT16_MIN;
+            other16[i] = INT16_MIN;
+            in32[i] = (i & 1) ? INT32_MAX / SCALE : INT32_MIN / SCALE + OFFSET;
+        } else {
+            in16[i] = (int16_t)next_random();
+            other16[i] = (int16_t)next_random();
+            in32[i] = (int32_t)(next_random() % 4096);  // Lecturas de 12 bits
+        }
+    }
+}
+
+/**
+ * @brief Compara cada núcleo con su versión escalar en largos 0..BLOCK (colas incluidas).
+ * @return Cantidad de diferencias.
+ */
+static int verify(void) {
+    static const size_t lengths[] = {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 100, BLOCK - 1, BLOCK};
+    int errors = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        fill_inputs(pass == 1);
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            size_t n = lengths[l];
+
+            vec_scale(in32, n, SCALE, out32);
+            scalar_scale(in32, n, SCALE, check32);
+            errors += memcmp(out32, check32, n * sizeof(*out32)) != 0;
+
+            vec_offset_scale(in32, n, OFFSET, SCALE, out32);
+            scalar_offset_scale(in32, n, OFFSET, SCALE, check32);
+            errors += memcmp(out32, check32, n * sizeof(*out32)) != 0;
+
+            memcpy(out32, in32, n * sizeof(*out32));
+            memcpy(check32, in32, n * sizeof(*out32));
+            vec_offset_scale_inplace(out32, n, OFFSET, SCALE);
+            scalar_offset_scale_inplace(check32, n, OFFSET, SCALE);
+            errors += memcmp(out32, check32, n * sizeof(*out32)) != 0;
+
+            memcpy(out32, in32, n * sizeof(*out32));
+            memcpy(check32, in32, n * sizeof(*out32));
+            vec_scale_inplace(out32, n, SCALE);
+            scalar_scale_inplace(check32, n, SCALE);
+            errors += memcmp(out32, check32, n * sizeof(*out32)) != 0;
+
+            for (int shift = 0; shift <= SHIFT; shift += SHIFT) {
+                vec_scale_sat16(in16, n, SCALE_Q15, shift, out16);
+                scalar_scale_sat16(in16, n, SCALE_Q15, shift, check16);
+                errors += memcmp(out16, check16, n * sizeof(*out16)) != 0;
+            }
+
+            errors += vec_dot(in16, other16, n) != scalar_dot(in16, other16, n);
+            errors += vec_dot(other16, other16, n) != scalar_dot(other16, other16, n);
+            errors += vec_sum_squares(in16, n) != scalar_sum_squares(in16, n);
+
+            int32_t lo, hi, check_lo, check_hi;
+            vec_minmax(in32, n, &lo, &hi);
+            scalar_minmax(in32, n, &check_lo, &check_hi);
+            errors += lo != check_lo || hi != check_hi;
+        }
+    }
+    fill_inputs(false);
+    return errors;
+}
+
+// ---------------------------------------------------------------------------
+// Funciones medidas (un bloque por llamada)
+// ---------------------------------------------------------------------------
+
+/**
+ * Los parámetros de los núcleos pasan por BENCH_LAUNDER: si no, GCC clona las
+ * versiones escalares con las constantes adentro (y con escala 1 borra el bucle).
+ */
+static void run_scale(void *ctx) {
+    (void)ctx;
+    int32_t scale = SCALE;
+    BENCH_LAUNDER(scale);
+    vec_scale(in32, BLOCK, scale, out32);
+    bench_escape(out32);
+}
+
+static void run_scalar_scale(void *ctx) {
+    (void)ctx;
+    int32_t scale = SCALE;
+    BENCH_LAUNDER(scale);
+    scalar_scale(in32, BLOCK, scale, out32);
+    bench_escape(out32);
+}
+
+static void run_scale_inplace(void *ctx) {
+    (void)ctx;
+    int32_t scale = 1;
+    BENCH_LAUNDER(scale);
+    vec_scale_inplace(out32, BLOCK, scale);
+    bench_escape(out32);
+}
+
+static void run_scalar_scale_inplace(void *ctx) {
+    (void)ctx;
+    int32_t scale = 1;
+    BENCH_LAUNDER(scale);
+    scalar_scale_inplace(out32, BLOCK, scale);
+    bench_escape(out32);
+}
+
+static void run_offset_scale(void *ctx) {
+    (void)ctx;
+    int32_t offset = OFFSET, scale = SCALE;
+    BENCH_LAUNDER(offset);
+    BENCH_LAUNDER(scale);
+    vec_offset_scale(in32, BLOCK, offset, scale, out32);
+    bench_escape(out32);
+}
+
+static void run_scalar_offset_scale(void *ctx) {
+    (void)ctx;
+    int32_t offset = OFFSET, scale = SCALE;
+    BENCH_LAUNDER(offset);
+    BENCH_LAUNDER(scale);
+    scalar_offset_scale(in32, BLOCK, offset, scale, out32);
+    bench_escape(out32);
+}
+
+static void run_offset_scale_inplace(void *ctx) {
+    (void)ctx;
+    int32_t offset = 0, scale = 1;
+    BENCH_LAUNDER(offset);
+    BENCH_LAUNDER(scale);
+    vec_offset_scale_inplace(out32, BLOCK, offset, scale);
+    bench_escape(out32);
+}
+
+static void run_scalar_offset_scale_inplace(void *ctx) {
+    (void)ctx;
+    int32_t offset = 0, scale = 1;
+    BENCH_LAUNDER(offset);
+    BENCH_LAUNDER(scale);
+    scalar_offset_scale_inplace(out32, BLOCK, offset, scale);
+    bench_escape(out32);
+}
+
+static void run_scale_sat16(void *ctx) {
+    (void)ctx;
+    int16_t scale = SCALE_Q15;
+    int shift = SHIFT;
+    BENCH_LAUNDER(scale);
+    BENCH_LAUNDER(shift);
+    vec_scale_sat16(in16, BLOCK, scale, shift, out16);
+    bench_escape(out16);
+}
+
+static void run_scalar_scale_sat16(void *ctx) {
+    (void)ctx;
+    int16_t scale = SCALE_Q15;
+    int shift = SHIFT;
+    BENCH_LAUNDER(scale);
+    BENCH_LAUNDER(shift);
+    scalar_scale_sat16(in16, BLOCK, scale, shift, out16);
+    bench_escape(out16);
+}
+
+static void run_dot(void *ctx) {
+    (void)ctx;
+    int64_t r = vec_dot(in16, other16, BLOCK);
+    BENCH_KEEP(r);
+}
+
+static void run_scalar_dot(void *ctx) {
+    (void)ctx;
+    int64_t r = scalar_dot(in16, other16, BLOCK);
+    BENCH_KEEP(r);
+}
+
+static void run_sum_squares(void *ctx) {
+    (void)ctx;
+    int64_t r = vec_sum_squares(in16, BLOCK);
+    BENCH_KEEP(r);
+}
+
+static void run_scalar_sum_squares(void *ctx) {
+    (void)ctx;
+    int64_t r = scalar_sum_squares(in16, BLOCK);
+    BENCH_KEEP(r);
+}
+
+static void run_minmax(void *ctx) {
+    (void)ctx;
+    int32_t lo, hi;
+    vec_minmax(in32, BLOCK, &lo, &hi);
+    BENCH_KEEP(lo);
+    BENCH_KEEP(hi);
+}
+
+static void run_scalar_minmax(void *ctx) {
+    (void)ctx;
+    int32_t lo, hi;
+    scalar_minmax(in32, BLOCK, &lo, &hi);
+    BENCH_KEEP(lo);
+    BENCH_KEEP(hi);
+}
+
+/**
+ * @struct kernel_pair_t
+ * @brief Un núcleo y su versión escalar.
+ */
+typedef struct {
+    const char *name;       /**< Nombre del núcleo. */
+    bench_fn_t kernel;      /**< Versión de la biblioteca. */
+    bench_fn_t scalar;      /**< Bucle escalar. */
+} kernel_pair_t;
+
+static const kernel_pair_t pairs[] = {
+    {"vec_scale", run_scale, run_scalar_scale},
+    {"vec_scale_inplace", run_scale_inplace, run_scalar_scale_inplace},
+    {"vec_offset_scale", run_offset_scale, run_scalar_offset_scale},
+    {"vec_offset_scale_inplace", run_offset_scale_inplace, run_scalar_offset_scale_inplace},
+    {"vec_scale_sat16", run_scale_sat16, run_scalar_scale_sat16},
+    {"vec_dot", run_dot, run_scalar_dot},
+    {"vec_sum_squares", run_sum_squares, run_scalar_sum_squares},
+    {"vec_minmax", run_minmax, run_scalar_minmax},
+};
+
+int main() {
+    bench_init();
+
+    int errors = verify();
+    if (errors) {
+        printf("Error: %d resultados distintos de la versión escalar (%s)\n", errors, vec_backend());
+        return bench_finish(1);
+    }
+
+    char names[2][64];
+    bench_result_t r;
+    bench_csv_header(stdout);
+    for (size_t k = 0; k < sizeof(pairs) / sizeof(pairs[0]); k++) {
+        snprintf(names[0], sizeof(names[0]), "%s[%s]", pairs[k].name, vec_backend());
+        snprintf(names[1], sizeof(names[1]), "%s[referencia]", pairs[k].name);
+
+        bench_run(names[0], pairs[k].kernel, NULL, NULL, &r);
+        bench_csv_row(stdout, &r);
+        bench_run(names[1], pairs[k].scalar, NULL, NULL, &r);
+        bench_csv_row(stdout, &r);
+    }
+    return bench_finish(0);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file vector_kernels.h
+ * @brief Núcleos sobre arreglos para bloques del ADC y series de RPM.
+ *
+ * Crecen de scaled_vector(pin, ion, scale, pout): mismos argumentos (entrada,
+ * largo, parámetros, salida), pero con punteros restrict, así el compilador
+ * sabe que la salida no pisa la entrada y puede vectorizar sin verificarlo en
+ * tiempo de ejecución. Por lo mismo las versiones sobre el mismo arreglo son
+ * funciones aparte (_inplace): pasar pin == pout a una función restrict es
+ * comportamiento indefinido.
+ *
+ * Implementación según la arquitectura de compilación:
+ * - Núcleos elemento a elemento (escala, desplazamiento y escala): bucles
+ *   simples que el compilador vectoriza solo con -O3 o -O2 -ftree-vectorize
+ *   para el conjunto de instrucciones elegido (-msse4.1, -mavx2, NEON).
+ * - Reducciones y saturación (producto punto, suma de cuadrados, mínimo y
+ *   máximo, escala saturada): intrínsecas explícitas AVX2, SSE4.1 o NEON
+ *   (AArch64), porque los compiladores no vectorizan bien acumuladores de
+ *   64 bits ni la saturación.
+ * - Cortex-M0+ (RP2040): bucles desenrollados de a 4, que con sus 8 registros
+ *   bajos es lo que cabe sin derramar a la pila.
+ * - Otras: el bucle escalar.
+ *
+ * Las multiplicaciones de 32 bits tienen la semántica de int de la versión
+ * original: quien llama debe evitar el desborde.
+ */
+
+#ifndef VECTOR_KERNELS_H
+#define VECTOR_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Nombre de la implementación compilada ("avx2", "sse4.1", "neon", "m0plus" o "escalar").
+ * @return Nombre.
+ */
+const char *vec_backend(void);
+
+/**
+ * @brief pout[i] = pin[i] * scale.
+ * @param pin Entrada.
+ * @param ion Cantidad de elementos.
+ * @param scale Factor de escala.
+ * @param pout Salida (no debe solaparse con @p pin).
+ */
+void vec_scale(const int32_t *restrict pin, size_t ion, int32_t scale, int32_t *restrict pout);
+
+/**
+ * @brief v[i] = v[i] * scale.
+ * @param v Arreglo a escalar.
+ * @param ion Cantidad de elementos.
+ * @param scale Factor de escala.
+ */
+void vec_scale_inplace(int32_t *v, size_t ion, int32_t scale);
+
+/**
+ * @brief pout[i] = (pin[i] - offset) * scale (por ejemplo, quitar el nivel de continua del ADC).
+ * @param pin Entrada.
+ * @param ion Cantidad de elementos.
+ * @param offset Valor que se resta antes de escalar.
+ * @param scale Factor de escala.
+ * @param pout Salida (no debe solaparse con @p pin).
+ */
+void vec_offset_scale(const int32_t *restrict pin, size_t ion, int32_t offset, int32_t scale,
+                      int32_t *restrict pout);
+
+/**
+ * @brief v[i] = (v[i] - offset) * scale.
+ * @param v Arreglo a transformar.
+ * @param ion Cantidad de elementos.
+ * @param offset Valor que se resta antes de escalar.
+ * @param scale Factor de escala.
+ */
+void vec_offset_scale_inplace(int32_t *v, size_t ion, int32_t offset, int32_t scale);
+
+/**
+ * @brief Escala saturada en punto fijo: pout[i] = sat16((pin[i] * scale) >> shift).
+ *
+ * Con shift = 15, @p scale es un factor Q15 (32767 ~ 1.0). El corrimiento es
+ * aritmético (redondea hacia menos infinito).
+ *
+ * @param pin Entrada.
+ * @param ion Cantidad de elementos.
+ * @param scale Factor de escala.
+ * @param shift Corrimiento a la derecha, 0..31.
+ * @param pout Salida (no debe solaparse con @p pin).
+ */
+void vec_scale_sat16(const int16_t *restrict pin, size_t ion, int16_t scale, int shift,
+                     int16_t *restrict pout);
+
+/**
+ * @brief Producto punto exacto de dos arreglos de 16 bits.
+ * @param a Primer arreglo.
+ * @param b Segundo arreglo.
+ * @param ion Cantidad de elementos.
+ * @return Suma de a[i] * b[i] en 64 bits (sin desborde hasta 2^33 elementos).
+ */
+int64_t vec_dot(const int16_t *restrict a, const int16_t *restrict b, size_t ion);
+
+/**
+ * @brief Suma de cuadrados exacta (energía de un bloque del ADC).
+ * @param pin Arreglo.
+ * @param ion Cantidad de elementos.
+ * @return Suma de pin[i]^2 en 64 bits.
+ */
+int64_t vec_sum_squares(const int16_t *restrict pin, size_t ion);
+
+/**
+ * @brief Mínimo y máximo de un arreglo.
+ * @param pin Arreglo.
+ * @param ion Cantidad de elementos (si es 0, min = INT32_MAX y max = INT32_MIN).
+ * @param min Mínimo.
+ * @param max Máximo.
+ */
+void vec_minmax(const int32_t *restrict pin, size_t ion, int32_t *min, int32_t *max);
+
+#endif // VECTOR_KERNELS_H
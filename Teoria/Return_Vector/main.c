@@ -1,17 +1,23 @@
-#include <stdio.h>
+/**
+ * @file main.c
+ * @brief Cómo retornar vectores en C: la función escribe en un arreglo del llamador.
+ *
+ * scaled_vector() pasó a la biblioteca de núcleos (src/vector_kernels.c) como
+ * vec_scale(), con los mismos argumentos. Las comparaciones de rendimiento
+ * contra el bucle escalar están en bench_vector.c.
+ *
+ * Compilación: gcc -O3 -I. main.c src/vector_kernels.c -o vector
+ */
 
-// Función para escalar el vector
-void scaled_vector(int *pin, int ion, int scale, int *pout) { 
-    for (int i = 0; i < ion; i++) {
-        pout[i] = pin[i] * scale;  // Escalamos y guardamos en pout
-    }
-}
+#include <stdio.h>
+#include <stdint.h>
+#include "include/vector_kernels.h"
 
 // Función para imprimir el vector en formato [x,y,z]
-void print_vector(int *pout, int ion) {
+void print_vector(const int32_t *pout, size_t ion) {
     printf("[");
-    for (int i = 0; i < ion; i++) {
-        printf("%d", pout[i]);
+    for (size_t i = 0; i < ion; i++) {
+        printf("%ld", (long)pout[i]);
         if (i < ion - 1) {
             printf(",");  // Agregamos coma entre elementos
         }
@@ -20,17 +26,16 @@ void print_vector(int *pout, int ion) {
 }
 
 int main() {
-    int pin[] = {8, 32, 45};  // Vector de entrada
-    int ion = sizeof(pin) / sizeof(pin[0]);  // Tamaño del vector
-    int scale = 2;  // Factor de escala
-    int pout[ion];  // Vector de salida
+    int32_t pin[] = {8, 32, 45};  // Vector de entrada
+    size_t ion = sizeof(pin) / sizeof(pin[0]);  // Tamaño del vector
+    int32_t scale = 2;  // Factor de escala
+    int32_t pout[sizeof(pin) / sizeof(pin[0])];  // Vector de salida
 
-    scaled_vector(pin, ion, scale, pout);  // Escalamos el vector
+    vec_scale(pin, ion, scale, pout);  // Escalamos el vector
     print_vector(pout, ion);  // Imprimimos el vector escalado
 
-    return 0;
+    vec_offset_scale_inplace(pout, ion, 16, 3);  // Mismo arreglo como entrada y salida
+    print_vector(pout, ion);
 
-      
-  
-  
-}
\ No newline at end of file
+    return 0;
+}
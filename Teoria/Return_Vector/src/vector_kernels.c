@@ -0,0 +1,287 @@
+/**
+ * @file vector_kernels.c
+ * @brief Implementación de los núcleos sobre arreglos.
+ *
+ * Cada versión vectorial procesa bloques completos y deja el resto de los
+ * elementos al mismo bucle escalar, así todas dan resultados idénticos.
+ */
+
+#include "include/vector_kernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VEC_AVX2 1
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define VEC_SSE41 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define VEC_NEON 1
+#elif defined(__ARM_ARCH_6M__)
+#define VEC_M0PLUS 1
+#endif
+
+/**
+ * Sesgo de los pares de _mm_madd_epi16: a0*b0 + a1*b1 va de -2^31 + 2^16 a
+ * 2^31, que no cabe en int32 por un solo valor (-32768 * -32768 dos veces).
+ * Restando 2^16 a cada par el rango queda dentro de int32, y la suma se
+ * corrige al final sumando 2^16 por cada par.
+ */
+#define MADD_BIAS 65536
+
+const char *vec_backend(void) {
+#if defined(VEC_AVX2)
+    return "avx2";
+#elif defined(VEC_SSE41)
+    return "sse4.1";
+#elif defined(VEC_NEON)
+    return "neon";
+#elif defined(VEC_M0PLUS)
+    return "m0plus";
+#else
+    return "escalar";
+#endif
+}
+
+/**
+ * @brief Satura un valor de 32 bits al rango de int16.
+ */
+static inline int16_t sat16(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+void vec_scale(const int32_t *restrict pin, size_t ion, int32_t scale, int32_t *restrict pout) {
+    size_t i = 0;
+#if defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        int32_t a = pin[i], b = pin[i + 1], c = pin[i + 2], d = pin[i + 3];
+        pout[i] = a * scale;
+        pout[i + 1] = b * scale;
+        pout[i + 2] = c * scale;
+        pout[i + 3] = d * scale;
+    }
+#endif
+    for (; i < ion; i++) {
+        pout[i] = pin[i] * scale;
+    }
+}
+
+void vec_scale_inplace(int32_t *v, size_t ion, int32_t scale) {
+    size_t i = 0;
+#if defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        v[i] *= scale;
+        v[i + 1] *= scale;
+        v[i + 2] *= scale;
+        v[i + 3] *= scale;
+    }
+#endif
+    for (; i < ion; i++) {
+        v[i] *= scale;
+    }
+}
+
+void vec_offset_scale(const int32_t *restrict pin, size_t ion, int32_t offset, int32_t scale,
+                      int32_t *restrict pout) {
+    size_t i = 0;
+#if defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        int32_t a = pin[i], b = pin[i + 1], c = pin[i + 2], d = pin[i + 3];
+        pout[i] = (a - offset) * scale;
+        pout[i + 1] = (b - offset) * scale;
+        pout[i + 2] = (c - offset) * scale;
+        pout[i + 3] = (d - offset) * scale;
+    }
+#endif
+    for (; i < ion; i++) {
+        pout[i] = (pin[i] - offset) * scale;
+    }
+}
+
+void vec_offset_scale_inplace(int32_t *v, size_t ion, int32_t offset, int32_t scale) {
+    size_t i = 0;
+#if defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        v[i] = (v[i] - offset) * scale;
+        v[i + 1] = (v[i + 1] - offset) * scale;
+        v[i + 2] = (v[i + 2] - offset) * scale;
+        v[i + 3] = (v[i + 3] - offset) * scale;
+    }
+#endif
+    for (; i < ion; i++) {
+        v[i] = (v[i] - offset) * scale;
+    }
+}
+
+void vec_scale_sat16(const int16_t *restrict pin, size_t ion, int16_t scale, int shift,
+                     int16_t *restrict pout) {
+    size_t i = 0;
+#if defined(VEC_AVX2)
+    __m256i k = _mm256_set1_epi32(scale);
+    __m128i s = _mm_cvtsi32_si128(shift);
+    for (; i + 16 <= ion; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(pin + i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+        lo = _mm256_sra_epi32(_mm256_mullo_epi32(lo, k), s);
+        hi = _mm256_sra_epi32(_mm256_mullo_epi32(hi, k), s);
+        // packs trabaja por mitades de 128 bits: se reordenan los bloques de 64
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *)(pout + i), packed);
+    }
+#elif defined(VEC_SSE41)
+    __m128i k = _mm_set1_epi32(scale);
+    __m128i s = _mm_cvtsi32_si128(shift);
+    for (; i + 8 <= ion; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(pin + i));
+        __m128i lo = _mm_cvtepi16_epi32(x);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(x, 8));
+        lo = _mm_sra_epi32(_mm_mullo_epi32(lo, k), s);
+        hi = _mm_sra_epi32(_mm_mullo_epi32(hi, k), s);
+        _mm_storeu_si128((__m128i *)(pout + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(VEC_NEON)
+    int16x4_t k = vdup_n_s16(scale);
+    int32x4_t s = vdupq_n_s32(-shift);
+    for (; i + 8 <= ion; i += 8) {
+        int16x8_t x = vld1q_s16(pin + i);
+        int32x4_t lo = vshlq_s32(vmull_s16(vget_low_s16(x), k), s);
+        int32x4_t hi = vshlq_s32(vmull_s16(vget_high_s16(x), k), s);
+        vst1q_s16(pout + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#elif defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        pout[i] = sat16(((int32_t)pin[i] * scale) >> shift);
+        pout[i + 1] = sat16(((int32_t)pin[i + 1] * scale) >> shift);
+        pout[i + 2] = sat16(((int32_t)pin[i + 2] * scale) >> shift);
+        pout[i + 3] = sat16(((int32_t)pin[i + 3] * scale) >> shift);
+    }
+#endif
+    for (; i < ion; i++) {
+        pout[i] = sat16(((int32_t)pin[i] * scale) >> shift);
+    }
+}
+
+int64_t vec_dot(const int16_t *restrict a, const int16_t *restrict b, size_t ion) {
+    int64_t acc = 0;
+    size_t i = 0;
+#if defined(VEC_AVX2)
+    __m256i bias = _mm256_set1_epi32(MADD_BIAS);
+    __m256i acc_lo = _mm256_setzero_si256(), acc_hi = _mm256_setzero_si256();
+    for (; i + 16 <= ion; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i pairs = _mm256_sub_epi32(_mm256_madd_epi16(x, y), bias);
+        acc_lo = _mm256_add_epi64(acc_lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+        acc_hi = _mm256_add_epi64(acc_hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(acc_lo, acc_hi));
+    acc = lanes[0] + lanes[1] + lanes[2] + lanes[3] + (int64_t)(i / 2) * MADD_BIAS;
+#elif defined(VEC_SSE41)
+    __m128i bias = _mm_set1_epi32(MADD_BIAS);
+    __m128i acc_lo = _mm_setzero_si128(), acc_hi = _mm_setzero_si128();
+    for (; i + 8 <= ion; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i pairs = _mm_sub_epi32(_mm_madd_epi16(x, y), bias);
+        acc_lo = _mm_add_epi64(acc_lo, _mm_cvtepi32_epi64(pairs));
+        acc_hi = _mm_add_epi64(acc_hi, _mm_cvtepi32_epi64(_mm_srli_si128(pairs, 8)));
+    }
+    __m128i sum = _mm_add_epi64(acc_lo, acc_hi);
+    acc = _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1) + (int64_t)(i / 2) * MADD_BIAS;
+#elif defined(VEC_NEON)
+    // Cada producto cabe en int32; vpadalq suma los pares directo en 64 bits
+    int64x2_t acc_lo = vdupq_n_s64(0), acc_hi = vdupq_n_s64(0);
+    for (; i + 8 <= ion; i += 8) {
+        int16x8_t x = vld1q_s16(a + i);
+        int16x8_t y = vld1q_s16(b + i);
+        acc_lo = vpadalq_s32(acc_lo, vmull_s16(vget_low_s16(x), vget_low_s16(y)));
+        acc_hi = vpadalq_s32(acc_hi, vmull_s16(vget_high_s16(x), vget_high_s16(y)));
+    }
+    acc = vaddvq_s64(vaddq_s64(acc_lo, acc_hi));
+#elif defined(VEC_M0PLUS)
+    // Sin MAC de 64 bits: cada producto se suma aparte (dos productos pueden desbordar int32)
+    for (; i + 4 <= ion; i += 4) {
+        acc += (int32_t)a[i] * b[i];
+        acc += (int32_t)a[i + 1] * b[i + 1];
+        acc += (int32_t)a[i + 2] * b[i + 2];
+        acc += (int32_t)a[i + 3] * b[i + 3];
+    }
+#endif
+    for (; i < ion; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+    return acc;
+}
+
+int64_t vec_sum_squares(const int16_t *restrict pin, size_t ion) {
+    // restrict solo prohíbe el solapamiento si se escribe: leer dos veces el mismo arreglo es válido
+    return vec_dot(pin, pin, ion);
+}
+
+void vec_minmax(const int32_t *restrict pin, size_t ion, int32_t *min, int32_t *max) {
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    size_t i = 0;
+#if defined(VEC_AVX2)
+    if (ion >= 8) {
+        __m256i vlo = _mm256_set1_epi32(INT32_MAX), vhi = _mm256_set1_epi32(INT32_MIN);
+        for (; i + 8 <= ion; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(pin + i));
+            vlo = _mm256_min_epi32(vlo, x);
+            vhi = _mm256_max_epi32(vhi, x);
+        }
+        __m128i l = _mm_min_epi32(_mm256_castsi256_si128(vlo), _mm256_extracti128_si256(vlo, 1));
+        __m128i h = _mm_max_epi32(_mm256_castsi256_si128(vhi), _mm256_extracti128_si256(vhi, 1));
+        l = _mm_min_epi32(l, _mm_shuffle_epi32(l, 0x4E));
+        h = _mm_max_epi32(h, _mm_shuffle_epi32(h, 0x4E));
+        l = _mm_min_epi32(l, _mm_shuffle_epi32(l, 0xB1));
+        h = _mm_max_epi32(h, _mm_shuffle_epi32(h, 0xB1));
+        lo = _mm_cvtsi128_si32(l);
+        hi = _mm_cvtsi128_si32(h);
+    }
+#elif defined(VEC_SSE41)
+    if (ion >= 4) {
+        __m128i l = _mm_set1_epi32(INT32_MAX), h = _mm_set1_epi32(INT32_MIN);
+        for (; i + 4 <= ion; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(pin + i));
+            l = _mm_min_epi32(l, x);
+            h = _mm_max_epi32(h, x);
+        }
+        l = _mm_min_epi32(l, _mm_shuffle_epi32(l, 0x4E));
+        h = _mm_max_epi32(h, _mm_shuffle_epi32(h, 0x4E));
+        l = _mm_min_epi32(l, _mm_shuffle_epi32(l, 0xB1));
+        h = _mm_max_epi32(h, _mm_shuffle_epi32(h, 0xB1));
+        lo = _mm_cvtsi128_si32(l);
+        hi = _mm_cvtsi128_si32(h);
+    }
+#elif defined(VEC_NEON)
+    if (ion >= 4) {
+        int32x4_t l = vdupq_n_s32(INT32_MAX), h = vdupq_n_s32(INT32_MIN);
+        for (; i + 4 <= ion; i += 4) {
+            int32x4_t x = vld1q_s32(pin + i);
+            l = vminq_s32(l, x);
+            h = vmaxq_s32(h, x);
+        }
+        lo = vminvq_s32(l);
+        hi = vmaxvq_s32(h);
+    }
+#elif defined(VEC_M0PLUS)
+    for (; i + 4 <= ion; i += 4) {
+        int32_t a = pin[i], b = pin[i + 1], c = pin[i + 2], d = pin[i + 3];
+        // Ordenar cada par primero: 1,5 comparaciones por elemento en vez de 2
+        if (a > b) { int32_t t = a; a = b; b = t; }
+        if (c > d) { int32_t t = c; c = d; d = t; }
+        if (a < lo) lo = a;
+        if (c < lo) lo = c;
+        if (b > hi) hi = b;
+        if (d > hi) hi = d;
+    }
+#endif
+    for (; i < ion; i++) {
+        if (pin[i] < lo) lo = pin[i];
+        if (pin[i] > hi) hi = pin[i];
+    }
+    *min = lo;
+    *max = hi;
+}
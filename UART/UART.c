@@ -1,13 +1,94 @@
+/**
+ * @file UART.c
+ * @brief Recepción por UART0 a 115200 con interrupción o DMA, búfer circular y LED de actividad.
+ *
+ * La versión anterior leía por sondeo y dormía 200 ms por cada carácter para
+ * encender el LED: a 115200 baudios la FIFO de 32 bytes se desborda en unos
+ * 3 ms y las ráfagas se perdían. Ahora la interrupción guarda los bytes
+ * (src/uart_rx.c), el bucle principal los consume sin bloquearse y el LED se
+ * apaga solo con una alarma. Con RX_USE_DMA = 1 los bytes los copia un canal
+ * DMA y la CPU solo publica la posición cada RX_POLL_US; la API de lectura es
+ * la misma. bench_rx.c compara los dos modos contra el sondeo.
+ *
+ * Prueba de conteo: después de 300 ms sin datos el programa responde por TX
+ * una línea con los bytes recibidos, su hash FNV-1a y los desbordes, y
+ * reinicia los contadores. prueba_conteo.py envía una ráfaga a velocidad de
+ * línea y compara la respuesta.
+ */
+
+#include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
 #include "hardware/gpio.h"
 
+#include "include/uart_rx.h"
+
 #define UART_ID uart0
 #define BAUD_RATE 115200
-#define UART_TX_PIN 0   // GP0 (no lo usas si solo recibes)
+#define UART_TX_PIN 0   // GP0 (respuesta de la prueba de conteo)
 #define UART_RX_PIN 1   // GP1
 #define LED_PIN 25      // LED integrado
 
+#ifndef RX_USE_DMA
+#define RX_USE_DMA 1         ///< 1: recepción por DMA; 0: por interrupción
+#endif
+#define RX_BUFFER_SIZE 1024  ///< Búfer circular: ~89 ms de datos a 115200 baudios
+#define RX_POLL_US 1000      ///< Período de publicación de la posición del DMA
+#define LED_PULSE_MS 50      ///< Duración del pulso del LED por actividad
+#define REPORT_IDLE_MS 300   ///< Silencio que cierra una ráfaga y dispara el informe
+
+#define FNV_OFFSET 2166136261u  ///< Valor inicial del hash FNV-1a de 32 bits
+#define FNV_PRIME 16777619u     ///< Primo del hash FNV-1a de 32 bits
+
+static uart_rx_t rx;                        ///< Estado de la recepción
+static uint8_t rx_buffer[RX_BUFFER_SIZE] __attribute__((aligned(RX_BUFFER_SIZE))); ///< Búfer circular (alineado para el anillo del DMA)
+static volatile bool led_busy = false;      ///< Hay un pulso en curso
+
+/**
+ * @brief Alarma que termina el pulso del LED.
+ */
+static int64_t led_off_callback(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    gpio_put(LED_PIN, 0);
+    led_busy = false;
+    return 0;  // No repetir
+}
+
+/**
+ * @brief Enciende el LED y programa su apagado sin bloquear.
+ *
+ * Durante un pulso no se reprograma nada, así que una ráfaga larga no genera
+ * una alarma por byte: el LED parpadea mientras haya tráfico.
+ */
+static void led_pulse(void) {
+    if (led_busy) {
+        return;
+    }
+    led_busy = true;
+    gpio_put(LED_PIN, 1);
+    if (add_alarm_in_ms(LED_PULSE_MS, led_off_callback, NULL, true) < 0) {
+        gpio_put(LED_PIN, 0);  // Sin alarmas libres: se omite el pulso
+        led_busy = false;
+    }
+}
+
+/**
+ * @brief Envía por TX el resultado de la ráfaga y reinicia los contadores.
+ */
+static void send_report(uint32_t bytes, uint32_t hash) {
+    uart_rx_stats_t stats;
+    uart_rx_get_stats(&rx, &stats, true);
+
+    char line[160];
+    snprintf(line, sizeof(line),
+             "bytes=%lu fnv=%08lx desbordes_hw=%lu desbordes_sw=%lu errores=%lu nivel_max=%lu\n",
+             (unsigned long)bytes, (unsigned long)hash, (unsigned long)stats.overrun_hw,
+             (unsigned long)stats.overrun_sw, (unsigned long)stats.errors,
+             (unsigned long)stats.max_level);
+    uart_puts(UART_ID, line);
+}
+
 int main() {
     // Inicializa UART
     uart_init(UART_ID, BAUD_RATE);
@@ -15,18 +96,37 @@ int main() {
     gpio_set_function(UART_RX_PIN, GPIO_FUNC_UART);
     uart_set_format(UART_ID, 8, 1, UART_PARITY_NONE);
     uart_set_hw_flow(UART_ID, false, false);
+#if RX_USE_DMA
+    if (!uart_rx_init_dma(&rx, UART_ID, rx_buffer, sizeof(rx_buffer), RX_POLL_US)) {
+        // Sin canal DMA o alarma libre: la misma API, llenada por interrupción
+        uart_rx_init(&rx, UART_ID, rx_buffer, sizeof(rx_buffer));
+        uart_puts(UART_ID, "DMA no disponible: recepción por interrupción\n");
+    }
+#else
+    uart_rx_init(&rx, UART_ID, rx_buffer, sizeof(rx_buffer));
+#endif
 
     // Inicializa LED
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
     gpio_put(LED_PIN, 0); // Apagado al inicio
 
+    uint8_t chunk[64];
+    uint32_t bytes = 0;
+    uint32_t hash = FNV_OFFSET;
+
     while (true) {
-        if (uart_is_readable(UART_ID)) {
-            char c = uart_getc(UART_ID);  // Recibe carácter
-            gpio_put(LED_PIN, 1);         // Enciende LED
-            sleep_ms(200);                // Lo mantiene prendido un rato
-            gpio_put(LED_PIN, 0);         // Apaga LED
+        size_t n = uart_rx_read(&rx, chunk, sizeof(chunk));
+        if (n > 0) {
+            for (size_t i = 0; i < n; i++) {
+                hash = (hash ^ chunk[i]) * FNV_PRIME;
+            }
+            bytes += n;
+            led_pulse();
+        } else if (uart_rx_idle(&rx, REPORT_IDLE_MS * 1000)) {
+            send_report(bytes, hash);
+            bytes = 0;
+            hash = FNV_OFFSET;
         }
     }
 
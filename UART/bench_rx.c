@@ -0,0 +1,206 @@
+/**
+ * @file bench_rx.c
+ * @brief Rendimiento y carga de CPU de la recepción UART: sondeo, interrupción y DMA.
+ *
+ * Conexión: un puente de GP4 (TX de uart1) a GP1 (RX de uart0). uart1
+ * transmite por DMA un patrón conocido sin usar la CPU, y uart0 lo recibe con
+ * cada uno de los tres métodos mientras el bucle principal hace trabajo de
+ * relleno en bloques cortos. La carga de CPU de la recepción es la fracción
+ * de bloques de relleno que se pierden respecto de una ventana sin tráfico
+ * (con el mismo método activo); de ahí salen también los ciclos por byte.
+ * Todos los bytes recibidos se comparan con el patrón.
+ *
+ * - sondeo: uart_is_readable()/uart_getc() entre bloques de relleno, como la
+ *   versión original de UART.c (sin el sleep_ms).
+ * - irq / dma: src/uart_rx.c, leyendo con uart_rx_read() entre bloques.
+ *
+ * El resultado sale por USB como CSV:
+ * modo,baudios,enviados,recibidos,perdidos,errores,bytes_por_s,carga_cpu_pct,ciclos_por_byte
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+
+#include "include/uart_rx.h"
+
+#define RX_UART uart0
+#define RX_PIN 1            // GP1: recibe
+#define TX_UART uart1
+#define TX_PIN 4            // GP4: transmite (puente a GP1)
+
+#define PATTERN_BITS 12                     ///< Patrón de 4096 bytes repetido por el anillo del DMA
+#define PATTERN_SIZE (1u << PATTERN_BITS)
+#define RX_BUFFER_SIZE 1024                 ///< Búfer circular de recepción
+#define RX_POLL_US 1000                     ///< Período de publicación del DMA
+#define WINDOW_MS 1000                      ///< Duración de cada transmisión
+#define WORK_ITERS 64                       ///< Iteraciones de un bloque de relleno (~3 us)
+
+/**
+ * @enum rx_mode_t
+ * @brief Método de recepción medido.
+ */
+typedef enum {
+    MODE_POLL,  ///< Sondeo de la FIFO
+    MODE_IRQ,   ///< Interrupción + búfer circular
+    MODE_DMA    ///< DMA + búfer circular
+} rx_mode_t;
+
+static const char *const mode_names[] = {"sondeo", "irq", "dma"};
+static const uint32_t bauds[] = {115200, 460800, 921600};
+
+static uint8_t pattern[PATTERN_SIZE] __attribute__((aligned(PATTERN_SIZE)));      ///< Datos enviados
+static uint8_t rx_buffer[RX_BUFFER_SIZE] __attribute__((aligned(RX_BUFFER_SIZE))); ///< Búfer de recepción
+static uart_rx_t rx;                ///< Recepción por interrupción o DMA
+static volatile uint32_t sink;      ///< Resultado del relleno (para que no se elimine)
+
+/**
+ * @brief Bloque de trabajo de relleno: un xorshift corto.
+ */
+static void work_chunk(void) {
+    uint32_t x = sink | 1u;
+    for (int i = 0; i < WORK_ITERS; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    sink = x;
+}
+
+/**
+ * @struct checker_t
+ * @brief Compara los bytes recibidos con el patrón.
+ */
+typedef struct {
+    uint32_t received;  /**< Bytes recibidos. */
+    uint32_t errors;    /**< Bytes distintos del esperado. */
+} checker_t;
+
+static inline void check_byte(checker_t *ck, uint8_t c) {
+    if (c != pattern[ck->received & (PATTERN_SIZE - 1)]) {
+        ck->errors++;
+    }
+    ck->received++;
+}
+
+/**
+ * @brief Lee lo que haya disponible con el método dado.
+ */
+static void consume(rx_mode_t mode, checker_t *ck) {
+    if (mode == MODE_POLL) {
+        while (uart_is_readable(RX_UART)) {
+            check_byte(ck, (uint8_t)uart_getc(RX_UART));
+        }
+        return;
+    }
+    uint8_t chunk[64];
+    size_t n;
+    while ((n = uart_rx_read(&rx, chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            check_byte(ck, chunk[i]);
+        }
+    }
+}
+
+/**
+ * @brief Bloques de relleno por microsegundo sin tráfico, con el método ya activo.
+ */
+static double idle_rate(rx_mode_t mode) {
+    checker_t ck = {0};
+    uint32_t chunks = 0;
+    uint64_t start = time_us_64();
+    uint64_t end = start + WINDOW_MS * 1000u / 2;
+    while (time_us_64() < end) {
+        work_chunk();
+        consume(mode, &ck);
+        chunks++;
+    }
+    return (double)chunks / (double)(time_us_64() - start);
+}
+
+/**
+ * @brief Transmite el patrón durante WINDOW_MS y mide la recepción.
+ */
+static void run_case(rx_mode_t mode, uint32_t baud, int tx_channel) {
+    uart_init(RX_UART, baud);
+    uint32_t actual = uart_init(TX_UART, baud);
+    if (mode == MODE_IRQ) {
+        uart_rx_init(&rx, RX_UART, rx_buffer, sizeof(rx_buffer));
+    } else if (mode == MODE_DMA && !uart_rx_init_dma(&rx, RX_UART, rx_buffer, sizeof(rx_buffer), RX_POLL_US)) {
+        printf("%s,%lu,sin canal DMA o alarma libre\n", mode_names[mode], (unsigned long)actual);
+        uart_deinit(RX_UART);
+        uart_deinit(TX_UART);
+        return;
+    }
+
+    double base = idle_rate(mode);
+
+    // 10 bits por byte (inicio + 8 datos + parada)
+    uint32_t sent = actual / 10 * WINDOW_MS / 1000;
+    checker_t ck = {0};
+    uint32_t chunks = 0;
+    dma_channel_set_read_addr((uint)tx_channel, pattern, false);
+    dma_channel_set_trans_count((uint)tx_channel, sent, true);
+    uint64_t start = time_us_64();
+
+    // Hasta que termine la transmisión y se vacíen la FIFO de TX y la línea
+    while (dma_channel_is_busy((uint)tx_channel) || uart_get_hw(TX_UART)->fr & UART_UARTFR_BUSY_BITS) {
+        work_chunk();
+        consume(mode, &ck);
+        chunks++;
+    }
+    uint64_t stop = time_us_64();
+    sleep_ms(5);  // Último byte en vuelo + publicación del DMA
+    consume(mode, &ck);
+
+    double elapsed_us = (double)(stop - start);
+    double load = 1.0 - ((double)chunks / elapsed_us) / base;
+    if (load < 0.0) load = 0.0;
+    double cycles_per_byte = ck.received ? load * elapsed_us * (clock_get_hz(clk_sys) / 1e6) / ck.received : 0.0;
+
+    printf("%s,%lu,%lu,%lu,%ld,%lu,%.0f,%.2f,%.1f\n", mode_names[mode], (unsigned long)actual,
+           (unsigned long)sent, (unsigned long)ck.received, (long)sent - (long)ck.received,
+           (unsigned long)ck.errors, ck.received / (elapsed_us / 1e6), load * 100.0, cycles_per_byte);
+
+    if (mode != MODE_POLL) {
+        uart_rx_deinit(&rx);
+    }
+    uart_deinit(RX_UART);
+    uart_deinit(TX_UART);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);  // Tiempo para abrir el monitor serial por USB
+
+    for (uint32_t i = 0; i < PATTERN_SIZE; i++) {
+        pattern[i] = (uint8_t)(i * 131u + (i >> 8));
+    }
+    gpio_set_function(RX_PIN, GPIO_FUNC_UART);
+    gpio_set_function(TX_PIN, GPIO_FUNC_UART);
+
+    // Transmisión por DMA: el patrón se repite con el anillo de lectura
+    int tx_channel = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)tx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_ring(&c, false, PATTERN_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(TX_UART, true));
+    dma_channel_configure((uint)tx_channel, &c, &uart_get_hw(TX_UART)->dr, pattern, 0, false);
+
+    printf("modo,baudios,enviados,recibidos,perdidos,errores,bytes_por_s,carga_cpu_pct,ciclos_por_byte\n");
+    for (size_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++) {
+        for (int mode = MODE_POLL; mode <= MODE_DMA; mode++) {
+            run_case((rx_mode_t)mode, bauds[b], tx_channel);
+        }
+    }
+    printf("fin\n");
+
+    while (true) {
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file uart_rx.h
+ * @brief Recepción UART por interrupción con búfer circular.
+ *
+ * La FIFO del UART del RP2040 tiene 32 bytes: a 115200 baudios se llena en
+ * menos de 3 ms. La interrupción de recepción (por nivel de la FIFO o por
+ * tiempo de espera) la vacía por completo en un búfer circular, y el programa
+ * principal consume del búfer cuando puede.
+ *
+ * El búfer es de un productor (la interrupción) y un consumidor (el bucle
+ * principal) sin bloqueos: solo la interrupción escribe head y solo el
+ * consumidor escribe tail. Los índices corren libres y el tamaño es potencia
+ * de 2, así que head - tail es la cantidad de bytes guardados aun después de
+ * dar la vuelta. Una barrera de memoria separa los datos del índice que los
+ * publica, por si el consumidor corre en el otro núcleo.
+ *
+ * Hay dos formas de llenar el búfer, con la misma API para el consumidor:
+ * - Interrupción (uart_rx_init()): la interrupción de recepción (por nivel de
+ *   la FIFO o por tiempo de espera) copia los bytes uno por uno.
+ * - DMA (uart_rx_init_dma()): un canal DMA escribe sin parar en el búfer, que
+ *   funciona como anillo de direcciones del DMA (alineado a su tamaño). Un
+ *   temporizador periódico lee la posición de escritura y la publica como
+ *   head; la CPU no toca cada byte. El período debe ser menor que el tiempo
+ *   que tarda el enlace en llenar el búfer (1024 bytes a 115200: 89 ms).
+ *
+ *   El head publicado atrasa hasta un período respecto del DMA, que puede
+ *   estar pisando los bytes más viejos sin que head - tail llegue al tamaño
+ *   del búfer. Por eso el consumidor da por pisados los datos en cuanto
+ *   head - tail supera tamaño - lap_margin, donde lap_margin son los bytes
+ *   que entran en un período al baudio configurado (más uno). Por DMA caben
+ *   sin pérdida tamaño - lap_margin bytes pendientes: a 115200 con 1 ms son
+ *   13 de 1024; con 10 ms, 117.
+ *
+ *   Como la alarma puede atrasarse y el DMA sigue escribiendo mientras se
+ *   copia, después de cada lectura se vuelve a leer la dirección de escritura
+ *   del DMA: si ya pasó tail + tamaño, la copia se descarta (la lectura
+ *   devuelve 0 o -1) y sus bytes se cuentan en overrun_sw. La posición del
+ *   DMA se conoce módulo el tamaño, así que esto vale mientras la alarma no se
+ *   atrase tanto como tarda el enlace en llenar el búfer entero.
+ *
+ * uart_rx_idle() detecta el fin de una ráfaga (línea en silencio después de
+ * recibir datos), útil para separar tramas como las sentencias NMEA del GPS.
+ *
+ * Los desbordes no se pierden en silencio: se cuentan los bytes que no
+ * cupieron en el búfer (o que el DMA pisó sin que se leyeran) y los
+ * desbordes de la FIFO del hardware.
+ */
+
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hardware/uart.h"
+#include "pico/time.h"
+
+/**
+ * @struct uart_rx_stats_t
+ * @brief Contadores de recepción (acumulados desde uart_rx_init() o el último reinicio).
+ */
+typedef struct {
+    uint32_t received;      /**< Bytes guardados en el búfer. */
+    uint32_t overrun_sw;    /**< Bytes descartados porque el búfer estaba lleno (o pisados por el DMA). */
+    uint32_t overrun_hw;    /**< Desbordes de la FIFO del UART (bit OE). */
+    uint32_t errors;        /**< Errores de trama, paridad o break (por DMA: eventos, no bytes). */
+    uint32_t max_level;     /**< Ocupación máxima del búfer. */
+} uart_rx_stats_t;
+
+/**
+ * @struct uart_rx_t
+ * @brief Estado de la recepción de un UART.
+ */
+typedef struct {
+    uart_inst_t *uart;          /**< UART asociado. */
+    uint8_t *buffer;            /**< Búfer circular (del llamador). */
+    uint32_t mask;              /**< Tamaño del búfer - 1. */
+    volatile uint32_t head;     /**< Próxima posición a escribir (solo la interrupción o el temporizador del DMA). */
+    volatile uint32_t tail;     /**< Próxima posición a leer (solo el consumidor). */
+    volatile uart_rx_stats_t stats; /**< Contadores (los escribe la interrupción). */
+    volatile uint32_t last_rx_us;   /**< Momento en que se publicó el último byte. */
+    uint32_t idle_head;         /**< head del último silencio informado (solo el consumidor). */
+    uint32_t dropped;           /**< Bytes pisados por el DMA antes de leerlos (solo el consumidor). */
+    uint32_t lap_margin;        /**< Bytes que el DMA puede llevar de ventaja sobre head (0 por interrupción). */
+    int dma_channel;            /**< Canal DMA (-1: recepción por interrupción). */
+    uint32_t dma_pos;           /**< Última posición de escritura del DMA vista por el temporizador. */
+    repeating_timer_t timer;    /**< Temporizador que publica la posición del DMA. */
+} uart_rx_t;
+
+/**
+ * @brief Inicializa la recepción por interrupción de un UART ya configurado (uart_init()).
+ *
+ * @param rx Estado a inicializar; debe vivir mientras la interrupción esté activa.
+ * @param uart uart0 o uart1.
+ * @param buffer Búfer circular.
+ * @param size Tamaño del búfer, potencia de 2.
+ * @return false si el tamaño no es potencia de 2.
+ */
+bool uart_rx_init(uart_rx_t *rx, uart_inst_t *uart, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Inicializa la recepción por DMA de un UART ya configurado (uart_init()).
+ *
+ * @param rx Estado a inicializar; debe vivir mientras el DMA esté activo.
+ * @param uart uart0 o uart1.
+ * @param buffer Búfer circular, alineado a su tamaño (__attribute__((aligned(N)))).
+ * @param size Tamaño del búfer, potencia de 2 entre 2 y 32768.
+ * @param poll_us Período con que se publica la posición del DMA.
+ * @return false si el búfer no cumple las condiciones, si en @p poll_us entra el búfer
+ *         entero al baudio configurado o si no hay canal DMA o alarma libre.
+ */
+bool uart_rx_init_dma(uart_rx_t *rx, uart_inst_t *uart, uint8_t *buffer, size_t size, uint32_t poll_us);
+
+/**
+ * @brief Desactiva la recepción (interrupción o DMA).
+ * @param rx Estado de la recepción.
+ */
+void uart_rx_deinit(uart_rx_t *rx);
+
+/**
+ * @brief Bytes disponibles para leer.
+ * @param rx Estado de la recepción.
+ * @return Cantidad de bytes en el búfer.
+ */
+size_t uart_rx_available(const uart_rx_t *rx);
+
+/**
+ * @brief Lee un byte sin bloquear.
+ * @param rx Estado de la recepción.
+ * @return El byte (0..255), o -1 si el búfer está vacío (o, por DMA, si el byte se pisó mientras se leía).
+ */
+int uart_rx_getc(uart_rx_t *rx);
+
+/**
+ * @brief Lee hasta @p max bytes sin bloquear.
+ * @param rx Estado de la recepción.
+ * @param dst Destino.
+ * @param max Capacidad de @p dst.
+ * @return Bytes copiados (0 si, por DMA, se pisaron mientras se copiaban: se cuentan en overrun_sw).
+ */
+size_t uart_rx_read(uart_rx_t *rx, uint8_t *dst, size_t max);
+
+/**
+ * @brief Indica una vez por ráfaga que la línea quedó en silencio después de recibir datos.
+ * @param rx Estado de la recepción.
+ * @param idle_us Silencio mínimo que cierra la ráfaga.
+ * @return true si llegaron bytes desde el último silencio informado y pasaron @p idle_us sin más.
+ */
+bool uart_rx_idle(uart_rx_t *rx, uint32_t idle_us);
+
+/**
+ * @brief Copia los contadores y opcionalmente los reinicia.
+ * @param rx Estado de la recepción.
+ * @param out Copia de los contadores.
+ * @param reset Ponerlos en cero después de copiarlos.
+ */
+void uart_rx_get_stats(uart_rx_t *rx, uart_rx_stats_t *out, bool reset);
+
+#endif // UART_RX_H
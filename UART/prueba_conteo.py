@@ -0,0 +1,110 @@
+"""
+@file prueba_conteo.py
+@brief Prueba de conteo de bytes para la recepción por interrupción de UART.c
+
+Envía ráfagas de bytes aleatorios a velocidad de línea (115200 baudios, sin
+pausas) por un adaptador USB-serial conectado a GP1 (RX de la Pico) y GP0
+(TX), espera la línea de informe que la Pico manda después de 300 ms de
+silencio y compara la cantidad de bytes y el hash FNV-1a con lo enviado.
+
+Uso: python prueba_conteo.py PUERTO [--bytes N] [--rafagas R] [--semilla S]
+Requiere pyserial (pip install pyserial).
+"""
+
+import argparse
+import random
+import sys
+import time
+
+import serial
+
+## @var FNV_OFFSET
+# @brief Valor inicial del hash FNV-1a de 32 bits (el mismo que UART.c)
+FNV_OFFSET = 2166136261
+
+## @var FNV_PRIME
+# @brief Primo del hash FNV-1a de 32 bits
+FNV_PRIME = 16777619
+
+
+def fnv1a(data):
+    """
+    @brief Hash FNV-1a de 32 bits.
+    @param data Bytes a resumir.
+    @return Hash como entero.
+    """
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def parse_report(line):
+    """
+    @brief Convierte "clave=valor clave=valor ..." en un diccionario.
+    @param line Línea de informe de la Pico.
+    @return Diccionario con los valores como texto.
+    """
+    return dict(item.split("=", 1) for item in line.split() if "=" in item)
+
+
+def run_burst(port, size, rng):
+    """
+    @brief Envía una ráfaga y verifica el informe.
+    @param port Puerto serial abierto.
+    @param size Bytes de la ráfaga.
+    @param rng Generador de números aleatorios.
+    @return True si la Pico recibió exactamente lo enviado.
+    """
+    data = bytes(rng.getrandbits(8) for _ in range(size))
+    port.reset_input_buffer()
+
+    start = time.perf_counter()
+    port.write(data)
+    port.flush()
+    elapsed = time.perf_counter() - start
+
+    line = port.readline().decode("ascii", errors="replace").strip()
+    if not line:
+        print("  sin respuesta de la Pico")
+        return False
+
+    report = parse_report(line)
+    received = int(report.get("bytes", -1))
+    digest = int(report.get("fnv", "0"), 16)
+    expected = fnv1a(data)
+
+    rate = size / elapsed if elapsed > 0 else 0.0
+    print(f"  enviados={size} ({rate:.0f} B/s) | {line}")
+    ok = received == size and digest == expected
+    if not ok:
+        print(f"  ERROR: se esperaba bytes={size} fnv={expected:08x}")
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Prueba de conteo de bytes por UART")
+    parser.add_argument("puerto", help="Puerto serial, por ejemplo /dev/ttyUSB0 o COM3")
+    parser.add_argument("--baudios", type=int, default=115200)
+    parser.add_argument("--bytes", type=int, default=100000, help="Bytes por ráfaga")
+    parser.add_argument("--rafagas", type=int, default=5)
+    parser.add_argument("--semilla", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.semilla)
+    # El informe llega 300 ms después del último byte; la espera cubre la ráfaga completa
+    timeout = args.bytes * 10 / args.baudios + 2.0
+    with serial.Serial(args.puerto, args.baudios, timeout=timeout) as port:
+        time.sleep(0.5)
+        failures = 0
+        for i in range(args.rafagas):
+            print(f"Ráfaga {i + 1}/{args.rafagas}")
+            if not run_burst(port, args.bytes, rng):
+                failures += 1
+
+    print("OK: sin pérdidas" if failures == 0 else f"FALLÓ: {failures} ráfagas con pérdidas")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,334 @@
+/**
+ * @file uart_rx.c
+ * @brief Implementación de la recepción UART por interrupción o por DMA.
+ */
+
+#include "include/uart_rx.h"
+#include <string.h>
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+
+#define DMA_TRANS_COUNT 0xFFFFFFFFu  ///< Transferencias por arranque del DMA (se rearma al terminar)
+#define DMA_MAX_RING 32768u          ///< Mayor anillo de direcciones del DMA (2^15 bytes)
+
+static uart_rx_t *instances[NUM_UARTS];  ///< Estado de cada UART con recepción por interrupción
+
+/**
+ * @brief Vacía la FIFO del UART en el búfer circular. Corre en la interrupción.
+ */
+static void uart_rx_drain(uart_rx_t *rx) {
+    uart_hw_t *hw = uart_get_hw(rx->uart);
+    uint32_t head = rx->head;
+    uint32_t tail = rx->tail;
+    uint32_t start = head;
+
+    while (!(hw->fr & UART_UARTFR_RXFE_BITS)) {
+        uint32_t dr = hw->dr;
+        // OE marca que después de este byte (válido) se perdieron otros por FIFO llena
+        if (dr & UART_UARTDR_OE_BITS) {
+            rx->stats.overrun_hw++;
+        }
+        if (dr & (UART_UARTDR_FE_BITS | UART_UARTDR_PE_BITS | UART_UARTDR_BE_BITS)) {
+            rx->stats.errors++;
+            continue;
+        }
+        if (head - tail > rx->mask) {
+            tail = rx->tail;  // El consumidor pudo haber liberado espacio
+            if (head - tail > rx->mask) {
+                rx->stats.overrun_sw++;
+                continue;
+            }
+        }
+        rx->buffer[head & rx->mask] = (uint8_t)dr;
+        head++;
+        rx->stats.received++;
+    }
+
+    if (head - tail > rx->stats.max_level) {
+        rx->stats.max_level = head - tail;
+    }
+    if (head != start) {
+        rx->last_rx_us = time_us_32();
+    }
+    __dmb();  // Los datos quedan escritos antes de publicar el índice
+    rx->head = head;
+}
+
+static void on_uart0_irq(void) {
+    uart_rx_drain(instances[0]);
+}
+
+static void on_uart1_irq(void) {
+    uart_rx_drain(instances[1]);
+}
+
+/**
+ * @brief Publica la posición de escritura del DMA. Corre en la alarma periódica.
+ *
+ * La distancia recorrida se calcula módulo el tamaño del búfer, así que el
+ * período tiene que ser menor que lo que tarda el DMA en dar una vuelta.
+ */
+static bool dma_poll(repeating_timer_t *timer) {
+    uart_rx_t *rx = timer->user_data;
+    uart_hw_t *hw = uart_get_hw(rx->uart);
+
+    uint32_t pos = (uint32_t)(dma_channel_hw_addr(rx->dma_channel)->write_addr - (uintptr_t)rx->buffer);
+    uint32_t delta = (pos - rx->dma_pos) & rx->mask;
+    rx->dma_pos = pos;
+
+    // Los bits de error no viajan con el byte por DMA: se leen del registro de estado
+    uint32_t rsr = hw->rsr;
+    if (rsr) {
+        if (rsr & UART_UARTRSR_OE_BITS) rx->stats.overrun_hw++;
+        if (rsr & (UART_UARTRSR_FE_BITS | UART_UARTRSR_PE_BITS | UART_UARTRSR_BE_BITS)) rx->stats.errors++;
+        hw->rsr = 0;  // Escribir cualquier valor los borra
+    }
+
+    // Con 2^32 transferencias el rearme llega después de días; la FIFO cubre la pausa
+    if (!dma_channel_is_busy(rx->dma_channel)) {
+        dma_channel_set_trans_count(rx->dma_channel, DMA_TRANS_COUNT, true);
+    }
+
+    if (delta) {
+        uint32_t head = rx->head + delta;
+        rx->stats.received += delta;
+        uint32_t level = head - rx->tail;
+        if (level > rx->stats.max_level) {
+            rx->stats.max_level = level;
+        }
+        rx->last_rx_us = time_us_32();
+        __dmb();
+        rx->head = head;
+    }
+    return true;  // Seguir repitiendo
+}
+
+/**
+ * @brief Bytes que recibe el UART en @p us microsegundos, redondeado hacia arriba.
+ *
+ * El baudio sale de los divisores que dejó uart_init() (la misma cuenta que
+ * uart_set_baudrate()), con 10 bits por byte (inicio + 8 datos + parada).
+ */
+static uint32_t bytes_in_us(uart_inst_t *uart, uint32_t us) {
+    uart_hw_t *hw = uart_get_hw(uart);
+    uint32_t div = (hw->ibrd << 6) | hw->fbrd;
+    uint64_t baud = div ? 4ull * clock_get_hz(clk_peri) / div : 0;
+    return (uint32_t)((baud * us + 9999999ull) / 10000000ull);
+}
+
+/**
+ * @brief Estado común de los dos modos.
+ */
+static bool rx_reset(uart_rx_t *rx, uart_inst_t *uart, uint8_t *buffer, size_t size) {
+    if (size == 0 || (size & (size - 1)) != 0) {
+        return false;
+    }
+    rx->uart = uart;
+    rx->buffer = buffer;
+    rx->mask = (uint32_t)size - 1;
+    rx->head = 0;
+    rx->tail = 0;
+    memset((void *)&rx->stats, 0, sizeof(rx->stats));
+    rx->last_rx_us = time_us_32();
+    rx->idle_head = 0;
+    rx->dropped = 0;
+    rx->lap_margin = 0;
+    rx->dma_channel = -1;
+    rx->dma_pos = 0;
+    return true;
+}
+
+bool uart_rx_init(uart_rx_t *rx, uart_inst_t *uart, uint8_t *buffer, size_t size) {
+    if (!rx_reset(rx, uart, buffer, size)) {
+        return false;
+    }
+
+    int index = uart_get_index(uart);
+    int irq = index == 0 ? UART0_IRQ : UART1_IRQ;
+    instances[index] = rx;
+    irq_set_exclusive_handler(irq, index == 0 ? on_uart0_irq : on_uart1_irq);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(uart, true, false);
+
+    // Interrupción con la FIFO a la mitad (16 bytes): la mitad de interrupciones que con
+    // el nivel mínimo y todavía 1,4 ms de margen a 115200. Lo que quede por debajo del
+    // nivel lo entrega la interrupción por tiempo de espera (32 bits sin datos).
+    hw_write_masked(&uart_get_hw(uart)->ifls, 2u << UART_UARTIFLS_RXIFLSEL_LSB,
+                    UART_UARTIFLS_RXIFLSEL_BITS);
+    return true;
+}
+
+bool uart_rx_init_dma(uart_rx_t *rx, uart_inst_t *uart, uint8_t *buffer, size_t size, uint32_t poll_us) {
+    if (size < 2 || size > DMA_MAX_RING || ((uintptr_t)buffer & (size - 1)) != 0 ||
+        !rx_reset(rx, uart, buffer, size)) {
+        return false;
+    }
+    // Lo que el DMA puede escribir entre dos publicaciones de head
+    rx->lap_margin = bytes_in_us(uart, poll_us) + 1;
+    if (rx->lap_margin >= size) {
+        return false;
+    }
+    int channel = dma_claim_unused_channel(false);
+    if (channel < 0) {
+        return false;
+    }
+    rx->dma_channel = channel;
+
+    // Lee siempre el registro de datos y escribe en el anillo (el DMA envuelve la dirección solo)
+    dma_channel_config c = dma_channel_get_default_config((uint)channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, (uint)__builtin_ctz((unsigned)size));
+    channel_config_set_dreq(&c, uart_get_dreq(uart, false));
+    dma_channel_configure((uint)channel, &c, buffer, &uart_get_hw(uart)->dr, DMA_TRANS_COUNT, true);
+
+    if (!add_repeating_timer_us(-(int64_t)poll_us, dma_poll, rx, &rx->timer)) {
+        dma_channel_abort((uint)channel);
+        dma_channel_unclaim((uint)channel);
+        rx->dma_channel = -1;
+        return false;
+    }
+    return true;
+}
+
+void uart_rx_deinit(uart_rx_t *rx) {
+    if (rx->dma_channel >= 0) {
+        cancel_repeating_timer(&rx->timer);
+        dma_channel_abort((uint)rx->dma_channel);
+        dma_channel_unclaim((uint)rx->dma_channel);
+        rx->dma_channel = -1;
+        return;
+    }
+    int index = uart_get_index(rx->uart);
+    uart_set_irq_enables(rx->uart, false, false);
+    irq_set_enabled(index == 0 ? UART0_IRQ : UART1_IRQ, false);
+    irq_remove_handler(index == 0 ? UART0_IRQ : UART1_IRQ, index == 0 ? on_uart0_irq : on_uart1_irq);
+    instances[index] = NULL;
+}
+
+/**
+ * @brief Posición de lectura del consumidor, saltando lo que el DMA ya pisó.
+ *
+ * Por interrupción head - tail nunca supera el tamaño. Por DMA el DMA va
+ * hasta lap_margin bytes por delante de head, así que con head - tail por
+ * encima de tamaño - lap_margin los bytes más viejos pueden estar pisados:
+ * ya no son válidos y se descartan todos.
+ */
+static uint32_t consumer_tail(uart_rx_t *rx, uint32_t head) {
+    uint32_t tail = rx->tail;
+    if (head - tail > rx->mask + 1 - rx->lap_margin) {
+        rx->dropped += head - tail;
+        tail = head;
+        rx->tail = tail;
+    }
+    return tail;
+}
+
+/**
+ * @brief Confirma, después de copiar desde @p tail, que el DMA no pisó esos bytes.
+ *
+ * consumer_tail() mira antes de copiar y con el head publicado; si la alarma
+ * se atrasó o la copia fue larga, el DMA pudo pasar tail + tamaño mientras
+ * tanto. Acá se reconstruye su posición absoluta con el head más reciente y
+ * la dirección de escritura actual (head y la posición del DMA coinciden
+ * módulo el tamaño). Si lo copiado ya no es válido se descarta todo hasta
+ * head y se cuenta como pisado.
+ * @return true si la copia es válida (siempre por interrupción).
+ */
+static bool copy_valid(uart_rx_t *rx, uint32_t tail) {
+    if (rx->dma_channel < 0) {
+        return true;
+    }
+    uint32_t head = rx->head;
+    __dmb();  // La posición del DMA se lee después que head: nunca queda detrás
+    uint32_t pos = (uint32_t)(dma_channel_hw_addr(rx->dma_channel)->write_addr - (uintptr_t)rx->buffer);
+    uint32_t written = head + ((pos - head) & rx->mask);
+    if (written - tail <= rx->mask + 1) {
+        return true;
+    }
+    rx->dropped += head - tail;
+    rx->tail = head;
+    return false;
+}
+
+size_t uart_rx_available(const uart_rx_t *rx) {
+    uint32_t count = rx->head - rx->tail;
+    return count > rx->mask + 1 - rx->lap_margin ? 0 : count;
+}
+
+int uart_rx_getc(uart_rx_t *rx) {
+    uint32_t head = rx->head;
+    uint32_t tail = consumer_tail(rx, head);
+    if (head == tail) {
+        return -1;
+    }
+    __dmb();  // Leer el dato después de ver el índice que lo publica
+    uint8_t c = rx->buffer[tail & rx->mask];
+    __dmb();  // Terminar de leer antes de liberar la posición
+    if (!copy_valid(rx, tail)) {
+        return -1;
+    }
+    rx->tail = tail + 1;
+    return c;
+}
+
+size_t uart_rx_read(uart_rx_t *rx, uint8_t *dst, size_t max) {
+    uint32_t head = rx->head;
+    uint32_t tail = consumer_tail(rx, head);
+    uint32_t count = head - tail;
+    if (count > max) {
+        count = (uint32_t)max;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    __dmb();
+
+    // Hasta dos copias: del final del búfer y desde el principio si dio la vuelta
+    uint32_t start = tail & rx->mask;
+    uint32_t first = rx->mask + 1 - start;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(dst, rx->buffer + start, first);
+    memcpy(dst + first, rx->buffer, count - first);
+
+    __dmb();
+    if (!copy_valid(rx, tail)) {
+        return 0;
+    }
+    rx->tail = tail + count;
+    return count;
+}
+
+bool uart_rx_idle(uart_rx_t *rx, uint32_t idle_us) {
+    // head antes que el momento: si llega un byte en medio, el momento es nuevo y se espera
+    uint32_t head = rx->head;
+    if (head == rx->idle_head) {
+        return false;
+    }
+    __dmb();
+    if (time_us_32() - rx->last_rx_us < idle_us) {
+        return false;
+    }
+    rx->idle_head = head;
+    return true;
+}
+
+void uart_rx_get_stats(uart_rx_t *rx, uart_rx_stats_t *out, bool reset) {
+    // Copia coherente si la interrupción o la alarma corren en este mismo núcleo
+    uint32_t saved = save_and_disable_interrupts();
+    memcpy(out, (const void *)&rx->stats, sizeof(*out));
+    if (reset) {
+        memset((void *)&rx->stats, 0, sizeof(rx->stats));
+    }
+    restore_interrupts(saved);
+
+    out->overrun_sw += rx->dropped;
+    if (reset) {
+        rx->dropped = 0;
+    }
+}